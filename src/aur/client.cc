@@ -3,25 +3,43 @@
 
 #include <curl/curl.h>
 #include <stdio.h>
+#include <sys/wait.h>
 #include <systemd/sd-event.h>
 #include <unistd.h>
 
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <random>
 #include <string_view>
+#include <tuple>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/functional/overload.h"
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/strip.h"
+#include "aur/offline_client.hh"
+#include "aur/rate_limiter.hh"
+#include "aur/response_cache.hh"
+#include "aur/tarball_extractor.hh"
 
 namespace fs = std::filesystem;
 
 namespace aur {
 
+namespace {
+class ResponseHandler;
+}  // namespace
+
 class ClientImpl : public Client {
  public:
   explicit ClientImpl(Client::Options options = Options());
@@ -36,12 +54,18 @@ class ClientImpl : public Client {
   void QueueRpcRequest(const RpcRequest& request,
                        RpcResponseCallback callback) override;
 
+  void QueueRpcViewRequest(const RpcRequest& request,
+                           RpcResponseViewCallback callback) override;
+
   void QueueRawRequest(const HttpRequest& request,
                        RawResponseCallback callback) override;
 
   void QueueCloneRequest(const CloneRequest& request,
                          CloneResponseCallback callback) override;
 
+  void QueueSnapshotRequest(const HttpRequest& request,
+                            CloneResponseCallback callback) override;
+
   // Wait for all pending requests to complete. Returns non-zero if any request
   // failed or was cancelled by a callback.
   int Wait() override;
@@ -50,17 +74,54 @@ class ClientImpl : public Client {
   using ActiveRequests =
       absl::flat_hash_set<std::variant<CURL*, sd_event_source*>>;
 
-  template <typename ResponseHandlerType>
+  // Queues |request|, with a new ResponseHandlerType constructed from
+  // |callback| and any further |args| to handle the response.
+  template <typename ResponseHandlerType, typename... Args>
   void QueueHttpRequest(const HttpRequest& request,
-                        ResponseHandlerType::CallbackType callback);
+                        ResponseHandlerType::CallbackType callback,
+                        Args&&... args);
 
-  template <typename ResponseHandlerType>
-  void QueueRpcRequest(const RpcRequest& request,
-                       ResponseHandlerType::CallbackType callback);
+  // Queues |request|, unless an identical request is already in flight, in
+  // which case |callback| is given a copy of that request's response.
+  void QueueCoalescedRpcRequest(const RpcRequest& request,
+                                RpcResponseCallback callback);
+  void QueueCoalescedRpcViewRequest(const RpcRequest& request,
+                                    RpcResponseViewCallback callback);
+
+  // Forks git for queued clone requests, as far as the concurrency limit
+  // allows.
+  void StartPendingClones();
+  void StartClone(const CloneRequest& request, CloneResponseCallback callback);
 
   int FinishRequest(CURL* curl, CURLcode result, bool dispatch_callback);
   int FinishRequest(sd_event_source* source);
 
+  // Returns an easy handle for a new transfer, reusing an idle one if there
+  // is one. Recycled handles keep their caches, e.g. of TLS sessions.
+  CURL* AcquireHandle();
+  void ReleaseHandle(CURL* curl);
+
+  // Hands |curl| to curl once |delay| has passed and the rate limit allows.
+  // If the transfer can't be scheduled, the request fails, and the result of
+  // its callback is returned.
+  int StartTransfer(CURL* curl, absl::Duration delay);
+
+  // Returns how long to wait before retrying the request on |curl|, if the
+  // server throttled it and it may be retried.
+  std::optional<absl::Duration> ThrottledRetryDelay(
+      CURL* curl, CURLcode result, const ResponseHandler& handler);
+
+  // Returns the time for which a cached response to |url| may be used without
+  // revalidating it.
+  absl::Duration CacheTtl(std::string_view url) const;
+
+  // Reconciles the outcome of a request with its cache entry, storing fresh
+  // responses and substituting the cached body where appropriate.
+  absl::Status UpdateCache(CURL* curl, ResponseHandler* handler,
+                           absl::Status status);
+
+  void QueueCachedResponse(ResponseHandler* handler);
+
   int CheckFinished();
   void CancelAll();
   void Cancel(const ActiveRequests::value_type& request);
@@ -89,12 +150,37 @@ class ClientImpl : public Client {
   static int OnCloneExit(sd_event_source* s, const siginfo_t* si,
                          void* userdata);
   static int OnCancel(sd_event_source* s, void* userdata);
+  static int OnCachedResponse(sd_event_source* s, void* userdata);
+  static int OnTransferDue(sd_event_source* s, uint64_t usec, void* userdata);
 
   Options options_;
+  std::optional<ResponseCache> cache_;
+  RateLimiter rate_limiter_;
+  std::minstd_rand random_{std::random_device{}()};
 
   CURLM* curl_multi_;
   ActiveRequests active_requests_;
 
+  // Shares DNS lookups, TLS sessions and connections between transfers.
+  CURLSH* curl_share_;
+
+  // Easy handles which have been reset and are ready to be reused.
+  std::vector<CURL*> idle_handles_;
+
+  // Transfers waiting to be started, and the timers which will start them.
+  absl::flat_hash_map<CURL*, sd_event_source*> delayed_transfers_;
+
+  // Callbacks waiting on the RPC requests in flight, keyed on the URL, payload
+  // and decoded fields of each request.
+  using RpcRequestKey = std::tuple<std::string, std::string, PackageFields>;
+  absl::flat_hash_map<RpcRequestKey, std::vector<RpcResponseCallback>>
+      inflight_rpcs_;
+  absl::flat_hash_map<RpcRequestKey, std::vector<RpcResponseViewCallback>>
+      inflight_rpc_views_;
+
+  std::deque<std::pair<CloneRequest, CloneResponseCallback>> pending_clones_;
+  int running_clones_ = 0;
+
   sigset_t saved_ss_{};
   sd_event* event_ = nullptr;
   sd_event_source* timer_ = nullptr;
@@ -132,10 +218,84 @@ absl::Status StatusFromCurlHandle(CURL* curl) {
   return absl::InternalError(absl::StrCat("HTTP ", http_status));
 }
 
+// Fills in the network side of |timing| from a completed transfer.
+void RecordTransfer(CURL* curl, RequestTiming* timing) {
+  curl_off_t namelookup = 0, connect = 0, appconnect = 0, starttransfer = 0,
+             total = 0, downloaded = 0;
+  curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &namelookup);
+  curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+  curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appconnect);
+  curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &starttransfer);
+  curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+  curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+
+  long header_size = 0, request_size = 0, num_connects = 0;
+  curl_easy_getinfo(curl, CURLINFO_HEADER_SIZE, &header_size);
+  curl_easy_getinfo(curl, CURLINFO_REQUEST_SIZE, &request_size);
+  curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &num_connects);
+
+  // curl reports each phase as the time elapsed since the start of the
+  // request, and phases which didn't happen, e.g. on a reused connection, as
+  // zero.
+  const auto phase = [](curl_off_t end, curl_off_t start) {
+    return absl::Microseconds(std::max<curl_off_t>(end - start, 0));
+  };
+
+  timing->dns = phase(namelookup, 0);
+  timing->connect = phase(connect, namelookup);
+  timing->tls =
+      appconnect > 0 ? phase(appconnect, connect) : absl::ZeroDuration();
+  timing->ttfb = phase(starttransfer, 0);
+  timing->transfer = phase(total, starttransfer);
+
+  // The transfer ends now, and started as long ago as it took.
+  timing->finish = absl::Now();
+  timing->start = timing->finish - absl::Microseconds(total);
+
+  timing->bytes_in = downloaded + header_size;
+  timing->bytes_out = request_size;
+  timing->reused_connection = num_connects == 0;
+}
+
+// Returns the value of |header| if it's an instance of the header |name|.
+std::optional<std::string_view> HeaderValue(std::string_view header,
+                                            std::string_view name) {
+  const auto colon = header.find(':');
+  if (colon == header.npos ||
+      !absl::EqualsIgnoreCase(header.substr(0, colon), name)) {
+    return std::nullopt;
+  }
+
+  return absl::StripAsciiWhitespace(header.substr(colon + 1));
+}
+
+// Parses the value of a Retry-After header, which is either a number of
+// seconds or an HTTP date.
+std::optional<absl::Duration> ParseRetryAfter(std::string_view value) {
+  if (int64_t seconds; absl::SimpleAtoi(value, &seconds)) {
+    return absl::Seconds(seconds);
+  }
+
+  if (absl::Time time;
+      absl::ParseTime("%a, %d %b %Y %H:%M:%S GMT", value, &time, nullptr)) {
+    return time - absl::Now();
+  }
+
+  return std::nullopt;
+}
+
+// The most that is allocated up front for a response body, whatever size the
+// server announces.
+constexpr size_t kMaxBodySizeHint = 64 << 20;
+
 class ResponseHandler {
  public:
   explicit ResponseHandler(ClientImpl* client) : client_(client) {}
-  virtual ~ResponseHandler() = default;
+  virtual ~ResponseHandler() {
+    if (cache.has_value()) {
+      curl_slist_free_all(cache->request_headers);
+    }
+  }
 
   ResponseHandler(const ResponseHandler&) = delete;
   ResponseHandler& operator=(const ResponseHandler&) = delete;
@@ -143,12 +303,49 @@ class ResponseHandler {
   ResponseHandler(ResponseHandler&&) = default;
   ResponseHandler& operator=(ResponseHandler&&) = default;
 
+  // Whether the handler needs the whole response body before it can do
+  // anything with it. Handlers which consume the body as it arrives aren't
+  // cached, and never see the body of an error response.
+  static constexpr bool kBuffersBody = true;
+
   static size_t BodyCallback(char* ptr, size_t size, size_t nmemb,
                              void* userdata) {
     auto* handler = static_cast<ResponseHandler*>(userdata);
 
-    handler->body.append(ptr, size * nmemb);
-    return size * nmemb;
+    // Returning anything other than the size of the chunk aborts the request.
+    return handler->ConsumeBody(std::string_view(ptr, size * nmemb))
+               ? size * nmemb
+               : 0;
+  }
+
+  static size_t HeaderCallback(char* buffer, size_t size, size_t nitems,
+                               void* userdata) {
+    auto* handler = static_cast<ResponseHandler*>(userdata);
+    const std::string_view header(buffer, size * nitems);
+
+    if (header.starts_with("HTTP/")) {
+      // A new response is starting, e.g. after a redirect. Forget about
+      // anything we saw previously.
+      handler->retry_after.reset();
+      if (handler->cache.has_value()) {
+        handler->cache->etag.clear();
+        handler->cache->last_modified.clear();
+      }
+    } else if (auto retry_after = HeaderValue(header, "Retry-After")) {
+      handler->retry_after = ParseRetryAfter(*retry_after);
+    } else if (auto length = HeaderValue(header, "Content-Length")) {
+      if (size_t size; absl::SimpleAtoi(*length, &size)) {
+        handler->ExpectBodySize(size);
+      }
+    } else if (handler->cache.has_value()) {
+      if (auto etag = HeaderValue(header, "ETag")) {
+        handler->cache->etag = *etag;
+      } else if (auto last_modified = HeaderValue(header, "Last-Modified")) {
+        handler->cache->last_modified = *last_modified;
+      }
+    }
+
+    return size * nitems;
   }
 
   static int DebugCallback(CURL*, curl_infotype type, char* data, size_t size,
@@ -164,16 +361,79 @@ class ResponseHandler {
   }
 
   int Finalize(absl::Status status) {
+    const absl::Time start = absl::Now();
+    const absl::Duration parse_before = timing.parse;
+
     int r = RunCallback(std::move(status));
+
+    if (stats != nullptr) {
+      timing.callback = absl::Now() - start - (timing.parse - parse_before);
+      stats->Record(std::move(timing));
+    }
+
     delete this;
     return r;
   }
 
   ClientImpl* client() const { return client_; }
 
+  // Discards whatever was received of the response, so that the request can
+  // be sent again.
+  virtual void Reset() { body.clear(); }
+
+  // Told the size of the response body, as announced by the server, before
+  // it arrives. Buffered bodies are allocated up front rather than grown as
+  // each chunk arrives. The announced size is that of the encoded body, so
+  // it's only a lower bound on the decoded size.
+  virtual void ExpectBodySize(size_t size) {
+    body.reserve(std::min(size, kMaxBodySizeHint));
+  }
+
   std::string body;
   std::array<char, CURL_ERROR_SIZE> error_buffer = {};
 
+  // The number of times the request has been retried, and how long the server
+  // last asked us to wait before doing so.
+  int retries = 0;
+  std::optional<absl::Duration> retry_after;
+
+  // State carried by requests which participate in response caching.
+  struct CacheState {
+    std::string url;
+    std::string payload;
+
+    // The previously cached response, if any.
+    std::optional<ResponseCache::Entry> entry;
+
+    // Validators received with the response.
+    std::string etag;
+    std::string last_modified;
+
+    curl_slist* request_headers = nullptr;
+  };
+  std::optional<CacheState> cache;
+
+  // Where the request's timing is recorded once it completes, if anywhere.
+  RequestStats* stats = nullptr;
+  RequestTiming timing;
+
+ protected:
+  // Runs |parse|, accounting the time it takes as time spent parsing.
+  template <typename F>
+  auto TimeParse(F&& parse) {
+    const absl::Time start = absl::Now();
+    auto result = std::forward<F>(parse)();
+    timing.parse += absl::Now() - start;
+    return result;
+  }
+
+  // Receives the next chunk of the response body. Returns false if the
+  // request should be aborted.
+  virtual bool ConsumeBody(std::string_view bytes) {
+    body.append(bytes);
+    return true;
+  }
+
  private:
   virtual int RunCallback(absl::Status status) = 0;
 
@@ -191,7 +451,8 @@ class TypedResponseHandler : public ResponseHandler {
  protected:
   int RunCallback(absl::Status status) override {
     if (status.ok()) {
-      return std::move(callback_)(ResponseT::Parse(std::move(body)));
+      return std::move(callback_)(
+          TimeParse([&] { return ResponseT::Parse(std::move(body)); }));
     }
 
     return std::move(callback_)(std::move(status));
@@ -201,7 +462,158 @@ class TypedResponseHandler : public ResponseHandler {
   CallbackType callback_;
 };
 
-using RpcResponseHandler = TypedResponseHandler<RpcResponse>;
+void MergeResponse(RpcResponse& into, RpcResponse from) {
+  absl::c_move(from.packages, std::back_inserter(into.packages));
+}
+
+void MergeResponse(RpcResponseView& into, RpcResponseView from) {
+  into.Append(std::move(from));
+}
+
+// RpcResponseMerger associates the shards of a single RPC request and issues
+// the caller's callback only after all of them have completed.
+template <typename ResponseT>
+class RpcResponseMerger {
+ public:
+  using CallbackType = Client::ResponseCallback<ResponseT>;
+
+  static RpcResponseMerger* New(CallbackType callback) {
+    return new RpcResponseMerger(std::move(callback));
+  }
+
+  CallbackType callback() {
+    ++inflight_calls_;
+
+    return [this](absl::StatusOr<ResponseT> response) {
+      status_.Update(response.status());
+      if (status_.ok()) {
+        MergeResponse(merged_, *std::move(response));
+      }
+
+      if (--inflight_calls_ > 0) {
+        return 0;
+      }
+
+      int r = status_.ok() ? std::move(callback_)(std::move(merged_))
+                           : std::move(callback_)(std::move(status_));
+      delete this;
+      return r;
+    };
+  }
+
+ private:
+  explicit RpcResponseMerger(CallbackType callback)
+      : callback_(std::move(callback)) {}
+
+  CallbackType callback_;
+  int inflight_calls_ = 0;
+
+  absl::Status status_;
+  ResponseT merged_;
+};
+
+// RpcResponseHandler decodes packages as the response arrives, rather than
+// buffering the body and parsing it once the transfer is complete. Responses
+// which participate in caching are buffered regardless, since the cache needs
+// the body, and might substitute its own.
+class RpcResponseHandler : public ResponseHandler {
+ public:
+  using CallbackType = Client::RpcResponseCallback;
+
+  RpcResponseHandler(ClientImpl* client, CallbackType callback,
+                     PackageFields fields)
+      : ResponseHandler(client),
+        callback_(std::move(callback)),
+        fields_(std::move(fields)),
+        parser_(fields_) {}
+
+  void Reset() override {
+    ResponseHandler::Reset();
+    parser_ = RpcResponseParser(fields_);
+  }
+
+  void ExpectBodySize(size_t size) override {
+    // Otherwise the body is never buffered.
+    if (cache.has_value()) {
+      ResponseHandler::ExpectBodySize(size);
+    }
+  }
+
+ protected:
+  bool ConsumeBody(std::string_view bytes) override {
+    if (cache.has_value()) {
+      return ResponseHandler::ConsumeBody(bytes);
+    }
+
+    // Errors are remembered by the parser, and reported by Finish. The body of
+    // an unsuccessful response is fed to the parser too, but never read back.
+    TimeParse([&] { return parser_.Feed(bytes); }).IgnoreError();
+    return true;
+  }
+
+ private:
+  int RunCallback(absl::Status status) override {
+    if (!status.ok()) {
+      return std::move(callback_)(std::move(status));
+    }
+
+    if (cache.has_value()) {
+      return std::move(callback_)(
+          TimeParse([&] { return RpcResponse::Parse(body, fields_); }));
+    }
+
+    return std::move(callback_)(
+        TimeParse([&] { return std::move(parser_).Finish(); }));
+  }
+
+  CallbackType callback_;
+  PackageFields fields_;
+  RpcResponseParser parser_;
+};
+
+// RpcResponseViewHandler serves every callback waiting on an RPC request.
+// Views can't be copied, so each callback is given a view parsed from its own
+// copy of the body.
+class RpcResponseViewHandler : public ResponseHandler {
+ public:
+  // Returns the callbacks waiting on the request, once it has completed.
+  using CallbackType =
+      absl::AnyInvocable<std::vector<Client::RpcResponseViewCallback>() &&>;
+
+  RpcResponseViewHandler(ClientImpl* client, CallbackType take_callbacks,
+                         PackageFields fields)
+      : ResponseHandler(client),
+        take_callbacks_(std::move(take_callbacks)),
+        fields_(std::move(fields)) {}
+
+ private:
+  int RunCallback(absl::Status status) override {
+    auto callbacks = std::move(take_callbacks_)();
+
+    int r = 0;
+    for (size_t i = 0; i < callbacks.size(); ++i) {
+      int cr;
+      if (status.ok()) {
+        // Only the last callback can have the original body.
+        std::string bytes = i + 1 < callbacks.size() ? body : std::move(body);
+        cr = std::move(callbacks[i])(TimeParse([&] {
+          return RpcResponseView::Parse(std::move(bytes), fields_);
+        }));
+      } else {
+        cr = std::move(callbacks[i])(status);
+      }
+      if (cr < 0 && r == 0) {
+        r = cr;
+      }
+    }
+
+    return r;
+  }
+
+  CallbackType take_callbacks_;
+  PackageFields fields_;
+};
+
 using RawResponseHandler = TypedResponseHandler<RawResponse>;
 
 class CloneResponseHandler : public TypedResponseHandler<CloneResponse> {
@@ -214,14 +626,97 @@ class CloneResponseHandler : public TypedResponseHandler<CloneResponse> {
   }
 };
 
+// SnapshotResponseHandler extracts a snapshot tarball into the current
+// directory while it's being downloaded, so that the tarball is never held in
+// memory or written to disk as a whole.
+class SnapshotResponseHandler : public ResponseHandler {
+ public:
+  using CallbackType = Client::CloneResponseCallback;
+
+  static constexpr bool kBuffersBody = false;
+
+  SnapshotResponseHandler(ClientImpl* client, CallbackType callback)
+      : ResponseHandler(client),
+        callback_(std::move(callback)),
+        extractor_(fs::current_path()) {}
+
+  // The body is extracted as it arrives, and never buffered.
+  void ExpectBodySize(size_t) override {}
+
+ protected:
+  bool ConsumeBody(std::string_view bytes) override {
+    extract_status_ = TimeParse([&] { return extractor_.Write(bytes); });
+    return extract_status_.ok();
+  }
+
+ private:
+  int RunCallback(absl::Status status) override {
+    // A failure to extract is what aborted the transfer, if anything did.
+    if (!extract_status_.ok()) {
+      return std::move(callback_)(std::move(extract_status_));
+    }
+
+    if (status.ok()) {
+      status = TimeParse([&] { return extractor_.Finish(); });
+    }
+    if (!status.ok()) {
+      return std::move(callback_)(std::move(status));
+    }
+
+    return std::move(callback_)(CloneResponse::Parse("snapshot"));
+  }
+
+  CallbackType callback_;
+  TarballExtractor extractor_;
+  absl::Status extract_status_;
+};
+
+// Runs |cmd| to completion, returning its exit status. Only for use in a
+// child process, which is free to block.
+int RunAndWait(const std::vector<const char*>& cmd) {
+  const int pid = fork();
+  if (pid < 0) {
+    return 1;
+  }
+
+  if (pid == 0) {
+    execvp(cmd[0], const_cast<char* const*>(cmd.data()));
+    _exit(127);
+  }
+
+  int status;
+  if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) {
+    return 1;
+  }
+  return WEXITSTATUS(status);
+}
+
 }  // namespace
 
-ClientImpl::ClientImpl(Options options) : options_(std::move(options)) {
+ClientImpl::ClientImpl(Options options)
+    : options_(std::move(options)),
+      rate_limiter_(options_.max_requests_per_second,
+                    std::max(1.0, options_.max_requests_per_second)) {
+  if (options_.cache_directory.has_value()) {
+    cache_.emplace(*options_.cache_directory);
+  }
+
   curl_global_init(CURL_GLOBAL_SSL);
   curl_multi_ = curl_multi_init();
 
+  // All transfers happen on this thread, so the share needs no locking.
+  curl_share_ = curl_share_init();
+  curl_share_setopt(curl_share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(curl_share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  curl_share_setopt(curl_share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
   curl_multi_setopt(curl_multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
-  curl_multi_setopt(curl_multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, 5L);
+  curl_multi_setopt(curl_multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                    static_cast<long>(options_.max_connections));
+  curl_multi_setopt(curl_multi_, CURLMOPT_MAX_HOST_CONNECTIONS,
+                    static_cast<long>(options_.max_host_connections));
+  curl_multi_setopt(curl_multi_, CURLMOPT_MAX_CONCURRENT_STREAMS,
+                    static_cast<long>(options_.max_streams_per_connection));
 
   curl_multi_setopt(curl_multi_, CURLMOPT_SOCKETFUNCTION,
                     &ClientImpl::SocketCallback);
@@ -247,7 +742,11 @@ ClientImpl::ClientImpl(Options options) : options_(std::move(options)) {
 }
 
 ClientImpl::~ClientImpl() {
+  for (auto* curl : idle_handles_) {
+    curl_easy_cleanup(curl);
+  }
   curl_multi_cleanup(curl_multi_);
+  curl_share_cleanup(curl_share_);
   curl_global_cleanup();
 
   sd_event_source_unref(timer_);
@@ -273,9 +772,13 @@ void ClientImpl::Cancel(const ActiveRequests::value_type& request) {
 int ClientImpl::OnCancel(sd_event_source*, void* userdata) {
   auto* client = static_cast<ClientImpl*>(userdata);
 
+  client->pending_clones_.clear();
+  client->inflight_rpcs_.clear();
+  client->inflight_rpc_views_.clear();
   while (!client->active_requests_.empty()) {
     client->Cancel(*client->active_requests_.begin());
   }
+  client->running_clones_ = 0;
 
   return 0;
 }
@@ -415,28 +918,203 @@ int ClientImpl::FinishRequest(CURL* curl, CURLcode result,
 
   int r = 0;
   if (dispatch_callback) {
+    if (auto delay = ThrottledRetryDelay(curl, result, *handler)) {
+      ++handler->retries;
+      handler->Reset();
+
+      curl_multi_remove_handle(curl_multi_, curl);
+      return StartTransfer(curl, *delay);
+    }
+
+    if (handler->stats != nullptr) {
+      RecordTransfer(curl, &handler->timing);
+    }
+
     absl::Status status =
-        result == CURLE_OK ? StatusFromCurlHandle(curl)
-                           : absl::UnknownError(handler->error_buffer.data());
+        result == CURLE_OK || result == CURLE_HTTP_RETURNED_ERROR
+            ? StatusFromCurlHandle(curl)
+            : absl::UnknownError(handler->error_buffer.data());
+
+    if (handler->cache.has_value()) {
+      status = UpdateCache(curl, handler, std::move(status));
+    }
 
     r = handler->Finalize(std::move(status));
   } else {
     delete handler;
   }
 
+  if (auto iter = delayed_transfers_.find(curl);
+      iter != delayed_transfers_.end()) {
+    sd_event_source_unref(iter->second);
+    delayed_transfers_.erase(iter);
+  }
+
   active_requests_.erase(curl);
   curl_multi_remove_handle(curl_multi_, curl);
-  curl_easy_cleanup(curl);
+  ReleaseHandle(curl);
 
   return r;
 }
 
+CURL* ClientImpl::AcquireHandle() {
+  if (idle_handles_.empty()) {
+    return curl_easy_init();
+  }
+
+  auto* curl = idle_handles_.back();
+  idle_handles_.pop_back();
+  return curl;
+}
+
+void ClientImpl::ReleaseHandle(CURL* curl) {
+  // Forgets every option, but keeps the handle's caches.
+  curl_easy_reset(curl);
+  idle_handles_.push_back(curl);
+}
+
+int ClientImpl::StartTransfer(CURL* curl, absl::Duration delay) {
+  const absl::Time now = absl::Now();
+  const absl::Time start = rate_limiter_.Acquire(now + delay);
+  if (start <= now) {
+    curl_multi_add_handle(curl_multi_, curl);
+    return 0;
+  }
+
+  sd_event_source* source;
+  const int r = sd_event_add_time(event_, &source, CLOCK_REALTIME,
+                                  absl::ToUnixMicros(start), 0,
+                                  &ClientImpl::OnTransferDue, curl);
+  if (r < 0) {
+    ResponseHandler* handler;
+    curl_easy_getinfo(curl, CURLINFO_PRIVATE, &handler);
+
+    active_requests_.erase(curl);
+    ReleaseHandle(curl);
+
+    return handler->Finalize(absl::InternalError(
+        absl::StrCat("failed to schedule request: ", strerror(-r))));
+  }
+
+  delayed_transfers_.emplace(curl, source);
+  return 0;
+}
+
+// static
+int ClientImpl::OnTransferDue(sd_event_source* source, uint64_t,
+                              void* userdata) {
+  auto* curl = static_cast<CURL*>(userdata);
+
+  ResponseHandler* handler;
+  curl_easy_getinfo(curl, CURLINFO_PRIVATE, &handler);
+  auto* client = handler->client();
+
+  client->delayed_transfers_.erase(curl);
+  sd_event_source_unref(source);
+
+  curl_multi_add_handle(client->curl_multi_, curl);
+  return 0;
+}
+
+std::optional<absl::Duration> ClientImpl::ThrottledRetryDelay(
+    CURL* curl, CURLcode result, const ResponseHandler& handler) {
+  if (result != CURLE_OK && result != CURLE_HTTP_RETURNED_ERROR) {
+    return std::nullopt;
+  }
+
+  long http_status = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_status);
+  if (http_status != 429 || handler.retries >= options_.max_retries) {
+    return std::nullopt;
+  }
+
+  // A stale response is preferable to waiting, see UpdateCache.
+  if (handler.cache.has_value() && handler.cache->entry.has_value()) {
+    return std::nullopt;
+  }
+
+  return RetryDelay(handler.retries, handler.retry_after,
+                    std::uniform_real_distribution<double>()(random_));
+}
+
 int ClientImpl::FinishRequest(sd_event_source* source) {
   active_requests_.erase(source);
   sd_event_source_unref(source);
   return 0;
 }
 
+absl::Duration ClientImpl::CacheTtl(std::string_view url) const {
+  absl::ConsumePrefix(&url, options_.proxy.value_or(options_.baseurl));
+
+  for (const auto& [endpoint, ttl] : options_.cache_ttls) {
+    if (url.starts_with(endpoint)) {
+      return ttl;
+    }
+  }
+
+  return absl::ZeroDuration();
+}
+
+absl::Status ClientImpl::UpdateCache(CURL* curl, ResponseHandler* handler,
+                                     absl::Status status) {
+  auto& cache = *handler->cache;
+
+  long http_status = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_status);
+
+  if (http_status == 304 && cache.entry.has_value()) {
+    // The server confirmed that our copy is still current.
+    cache.entry->fetched = absl::Now();
+    cache_->Store(cache.url, cache.payload, *cache.entry).IgnoreError();
+
+    handler->body = std::move(cache.entry->body);
+    return absl::OkStatus();
+  }
+
+  if (status.ok()) {
+    ResponseCache::Entry entry{
+        .fetched = absl::Now(),
+        .etag = std::move(cache.etag),
+        .last_modified = std::move(cache.last_modified),
+        .body = std::move(handler->body),
+    };
+    cache_->Store(cache.url, cache.payload, entry).IgnoreError();
+
+    handler->body = std::move(entry.body);
+    return status;
+  }
+
+  // Prefer a stale response over failing outright when the AUR is throttling
+  // us or is otherwise unavailable.
+  if (cache.entry.has_value() && !absl::IsNotFound(status)) {
+    handler->body = std::move(cache.entry->body);
+    return absl::OkStatus();
+  }
+
+  return status;
+}
+
+void ClientImpl::QueueCachedResponse(ResponseHandler* handler) {
+  sd_event_source* source;
+  sd_event_add_defer(event_, &source, &ClientImpl::OnCachedResponse, handler);
+
+  active_requests_.emplace(source);
+}
+
+// static
+int ClientImpl::OnCachedResponse(sd_event_source* source, void* userdata) {
+  auto* handler = static_cast<ResponseHandler*>(userdata);
+  auto* client = handler->client();
+
+  client->FinishRequest(source);
+
+  if (handler->Finalize(absl::OkStatus()) < 0) {
+    client->CancelAll();
+  }
+
+  return 0;
+}
+
 int ClientImpl::CheckFinished() {
   int unused;
 
@@ -470,29 +1148,84 @@ int ClientImpl::Wait() {
   return cancelled_ ? -ECANCELED : 0;
 }
 
-template <typename ResponseHandlerType>
+template <typename ResponseHandlerType, typename... Args>
 void ClientImpl::QueueHttpRequest(const HttpRequest& request,
-                                  ResponseHandlerType::CallbackType callback) {
-  auto* curl = curl_easy_init();
-  auto* handler = new ResponseHandlerType(this, std::move(callback));
+                                  ResponseHandlerType::CallbackType callback,
+                                  Args&&... args) {
+  auto* handler = new ResponseHandlerType(this, std::move(callback),
+                                          std::forward<Args>(args)...);
+  const auto url = request.Url(options_.proxy.value_or(options_.baseurl));
+
+  if (options_.stats != nullptr) {
+    handler->stats = options_.stats;
+    handler->timing.url = url;
+  }
+
+  if (ResponseHandlerType::kBuffersBody && cache_.has_value()) {
+    auto& cache = handler->cache.emplace();
+    cache.url = url;
+    cache.payload = request.Payload();
+    cache.entry = cache_->Lookup(cache.url, cache.payload);
+
+    if (cache.entry.has_value()) {
+      if (absl::Now() - cache.entry->fetched < CacheTtl(url)) {
+        handler->body = std::move(cache.entry->body);
+        handler->timing.cached = true;
+        QueueCachedResponse(handler);
+        return;
+      }
+
+      if (!cache.entry->etag.empty()) {
+        cache.request_headers = curl_slist_append(
+            cache.request_headers,
+            absl::StrCat("If-None-Match: ", cache.entry->etag).c_str());
+      }
+      if (!cache.entry->last_modified.empty()) {
+        cache.request_headers = curl_slist_append(
+            cache.request_headers,
+            absl::StrCat("If-Modified-Since: ", cache.entry->last_modified)
+                .c_str());
+      }
+    }
+  }
+
+  auto* curl = AcquireHandle();
 
   using RH = ResponseHandler;
-  curl_easy_setopt(
-      curl, CURLOPT_URL,
-      request.Url(options_.proxy.value_or(options_.baseurl)).c_str());
+  curl_easy_setopt(curl, CURLOPT_SHARE, curl_share_);
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
   curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2);
   curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
-  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS,
+                   static_cast<long>(
+                       absl::ToInt64Milliseconds(options_.connect_timeout)));
+  if (options_.keepalive > absl::ZeroDuration()) {
+    const long keepalive = std::max<long>(
+        1, absl::ToInt64Seconds(options_.keepalive));
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, keepalive);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, keepalive);
+  }
   curl_easy_setopt(curl, CURLOPT_USERAGENT, options_.useragent.c_str());
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &RH::BodyCallback);
   curl_easy_setopt(curl, CURLOPT_WRITEDATA, handler);
   curl_easy_setopt(curl, CURLOPT_PRIVATE, handler);
   curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, handler->error_buffer.data());
+  curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &RH::HeaderCallback);
+  curl_easy_setopt(curl, CURLOPT_HEADERDATA, handler);
 
   if (request.command() == RpcRequest::Command::POST) {
     curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, request.Payload().c_str());
   }
 
+  if (!ResponseHandlerType::kBuffersBody) {
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+  }
+
+  if (handler->cache.has_value()) {
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, handler->cache->request_headers);
+  }
+
   switch (debug_level_) {
     case DebugLevel::NONE:
       break;
@@ -505,16 +1238,20 @@ void ClientImpl::QueueHttpRequest(const HttpRequest& request,
       break;
   }
 
-  curl_multi_add_handle(curl_multi_, curl);
   active_requests_.emplace(curl);
+  if (StartTransfer(curl, absl::ZeroDuration()) < 0) {
+    CancelAll();
+  }
 }
 
 // static
 int ClientImpl::OnCloneExit(sd_event_source* source, const siginfo_t* si,
                             void* userdata) {
   auto* handler = static_cast<CloneResponseHandler*>(userdata);
+  auto* client = handler->client();
 
-  handler->client()->FinishRequest(source);
+  client->FinishRequest(source);
+  --client->running_clones_;
 
   absl::Status status;
   if (si->si_status != 0) {
@@ -522,11 +1259,33 @@ int ClientImpl::OnCloneExit(sd_event_source* source, const siginfo_t* si,
         absl::StrCat("git exited with unexpected exit status ", si->si_status));
   }
 
-  return handler->Finalize(std::move(status));
+  const int r = handler->Finalize(std::move(status));
+  if (!client->cancelled_) {
+    client->StartPendingClones();
+  }
+
+  return r;
 }
 
 void ClientImpl::QueueCloneRequest(const CloneRequest& request,
                                    CloneResponseCallback callback) {
+  pending_clones_.emplace_back(request, std::move(callback));
+  StartPendingClones();
+}
+
+void ClientImpl::StartPendingClones() {
+  while (!pending_clones_.empty() &&
+         (options_.max_parallel_clones <= 0 ||
+          running_clones_ < options_.max_parallel_clones)) {
+    auto [request, callback] = std::move(pending_clones_.front());
+    pending_clones_.pop_front();
+
+    StartClone(request, std::move(callback));
+  }
+}
+
+void ClientImpl::StartClone(const CloneRequest& request,
+                            CloneResponseCallback callback) {
   const bool update = fs::exists(fs::path(request.reponame()) / ".git");
 
   auto* handler = new CloneResponseHandler(this, std::move(callback),
@@ -541,9 +1300,42 @@ void ClientImpl::QueueCloneRequest(const CloneRequest& request,
 
   if (pid == 0) {
     const auto url = request.Url(options_.baseurl);
+    const auto depth = absl::StrCat("--depth=", request.depth());
+    const auto filter = absl::StrCat("--filter=", request.filter());
 
     std::vector<const char*> cmd;
-    if (update) {
+    if (update && request.depth() > 0) {
+      // Once upstream moves past the commits of a shallow clone, the two no
+      // longer share any history, so the clone can be neither rebased nor
+      // fast-forwarded. Fetch the new commits to the same depth instead, and
+      // move the branch onto them, keeping any uncommitted changes.
+      // clang-format off
+      const int r = RunAndWait({
+        "git",
+         "-C",
+        request.reponame().c_str(),
+        "fetch",
+         "--quiet",
+         depth.c_str(),
+        nullptr,
+      });
+      // clang-format on
+      if (r != 0) {
+        _exit(r);
+      }
+
+      // clang-format off
+      cmd = {
+        "git",
+         "-C",
+        request.reponame().c_str(),
+        "reset",
+         "--quiet",
+         "--keep",
+        "FETCH_HEAD",
+      };
+      // clang-format on
+    } else if (update) {
       // clang-format off
       cmd = {
         "git",
@@ -562,9 +1354,15 @@ void ClientImpl::QueueCloneRequest(const CloneRequest& request,
         "git",
         "clone",
         "--quiet",
-        url.c_str(),
       };
       // clang-format on
+      if (request.depth() > 0) {
+        cmd.push_back(depth.c_str());
+      }
+      if (!request.filter().empty()) {
+        cmd.push_back(filter.c_str());
+      }
+      cmd.push_back(url.c_str());
     }
     cmd.push_back(nullptr);
 
@@ -577,6 +1375,7 @@ void ClientImpl::QueueCloneRequest(const CloneRequest& request,
                      handler);
 
   active_requests_.emplace(child);
+  ++running_clones_;
 }
 
 void ClientImpl::QueueRawRequest(const HttpRequest& request,
@@ -584,12 +1383,107 @@ void ClientImpl::QueueRawRequest(const HttpRequest& request,
   QueueHttpRequest<RawResponseHandler>(request, std::move(callback));
 }
 
+void ClientImpl::QueueSnapshotRequest(const HttpRequest& request,
+                                      CloneResponseCallback callback) {
+  QueueHttpRequest<SnapshotResponseHandler>(request, std::move(callback));
+}
+
+void ClientImpl::QueueCoalescedRpcRequest(const RpcRequest& request,
+                                          RpcResponseCallback callback) {
+  auto key = std::tuple(request.Url(options_.proxy.value_or(options_.baseurl)),
+                        request.Payload(), request.fields());
+
+  auto [iter, inserted] = inflight_rpcs_.try_emplace(key);
+  iter->second.push_back(std::move(callback));
+  if (!inserted) {
+    return;
+  }
+
+  QueueHttpRequest<RpcResponseHandler>(
+      request, [this, key = std::move(key)](
+                   absl::StatusOr<RpcResponse> response) {
+        // Stop accepting waiters before running any callbacks, so that a
+        // callback which asks for the same thing again gets a new request.
+        auto node = inflight_rpcs_.extract(key);
+        if (node.empty()) {
+          return 0;
+        }
+
+        auto& callbacks = node.mapped();
+        int r = 0;
+        for (size_t i = 0; i < callbacks.size(); ++i) {
+          // Only the last callback can have the original response.
+          const int cr = i + 1 < callbacks.size()
+                             ? std::move(callbacks[i])(response)
+                             : std::move(callbacks[i])(std::move(response));
+          if (cr < 0 && r == 0) {
+            r = cr;
+          }
+        }
+
+        return r;
+      },
+      request.fields());
+}
+
+void ClientImpl::QueueCoalescedRpcViewRequest(
+    const RpcRequest& request, RpcResponseViewCallback callback) {
+  auto key = std::tuple(request.Url(options_.proxy.value_or(options_.baseurl)),
+                        request.Payload(), request.fields());
+
+  auto [iter, inserted] = inflight_rpc_views_.try_emplace(key);
+  iter->second.push_back(std::move(callback));
+  if (!inserted) {
+    return;
+  }
+
+  QueueHttpRequest<RpcResponseViewHandler>(
+      request,
+      [this, key = std::move(key)] {
+        // Stop accepting waiters before running any callbacks, so that a
+        // callback which asks for the same thing again gets a new request.
+        auto node = inflight_rpc_views_.extract(key);
+        if (node.empty()) {
+          return std::vector<RpcResponseViewCallback>();
+        }
+        return std::move(node.mapped());
+      },
+      request.fields());
+}
+
 void ClientImpl::QueueRpcRequest(const RpcRequest& request,
                                  RpcResponseCallback callback) {
-  QueueHttpRequest<RpcResponseHandler>(request, std::move(callback));
+  auto shards = request.Shard(options_.max_args_per_request);
+  if (shards.size() == 1) {
+    QueueCoalescedRpcRequest(request, std::move(callback));
+    return;
+  }
+
+  auto* merger = RpcResponseMerger<RpcResponse>::New(std::move(callback));
+  for (const auto& shard : shards) {
+    QueueCoalescedRpcRequest(shard, merger->callback());
+  }
+}
+
+void ClientImpl::QueueRpcViewRequest(const RpcRequest& request,
+                                     RpcResponseViewCallback callback) {
+  auto shards = request.Shard(options_.max_args_per_request);
+  if (shards.size() == 1) {
+    QueueCoalescedRpcViewRequest(request, std::move(callback));
+    return;
+  }
+
+  auto* merger = RpcResponseMerger<RpcResponseView>::New(std::move(callback));
+  for (const auto& shard : shards) {
+    QueueCoalescedRpcViewRequest(shard, merger->callback());
+  }
 }
 
 std::unique_ptr<Client> Client::New(Client::Options options) {
+  if (options.offline_index.has_value()) {
+    return NewOfflineClient(std::move(*options.offline_index));
+  }
+
   return std::make_unique<ClientImpl>(std::move(options));
 }
 
@@ -2,13 +2,19 @@
 #ifndef AUR_CLIENT_HH_
 #define AUR_CLIENT_HH_
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/time/time.h"
 #include "aur/request.hh"
+#include "aur/request_stats.hh"
 #include "aur/response.hh"
+#include "aur/response_view.hh"
 
 namespace aur {
 
@@ -19,6 +25,7 @@ class Client {
       absl::AnyInvocable<int(absl::StatusOr<ResponseType>) &&>;
 
   using RpcResponseCallback = ResponseCallback<RpcResponse>;
+  using RpcResponseViewCallback = ResponseCallback<RpcResponseView>;
   using RawResponseCallback = ResponseCallback<RawResponse>;
   using CloneResponseCallback = ResponseCallback<CloneResponse>;
 
@@ -48,9 +55,120 @@ class Client {
       return *this;
     }
     std::string useragent;
+
+    // Maximum number of arguments carried by a single RPC request. Larger
+    // requests are split into shards which are issued concurrently, and whose
+    // results are merged into a single response. Zero disables sharding.
+    Options& set_max_args_per_request(int max_args_per_request) {
+      this->max_args_per_request = max_args_per_request;
+      return *this;
+    }
+    int max_args_per_request = 150;
+
+    // Maximum number of connections open at once, in total and to any single
+    // host. Zero means no limit.
+    Options& set_max_connections(int max_connections) {
+      this->max_connections = max_connections;
+      return *this;
+    }
+    int max_connections = 5;
+
+    Options& set_max_host_connections(int max_host_connections) {
+      this->max_host_connections = max_host_connections;
+      return *this;
+    }
+    int max_host_connections = 0;
+
+    // Maximum number of requests multiplexed over a single HTTP/2 connection.
+    // Further requests open another connection, as far as max_connections
+    // allows, or wait their turn.
+    Options& set_max_streams_per_connection(int max_streams_per_connection) {
+      this->max_streams_per_connection = max_streams_per_connection;
+      return *this;
+    }
+    int max_streams_per_connection = 100;
+
+    // Time allowed for establishing a connection, including the TLS
+    // handshake.
+    Options& set_connect_timeout(absl::Duration connect_timeout) {
+      this->connect_timeout = connect_timeout;
+      return *this;
+    }
+    absl::Duration connect_timeout = absl::Seconds(10);
+
+    // Idle time after which TCP keepalive probes are sent on a connection,
+    // and the interval between them. Zero disables keepalive probes.
+    Options& set_keepalive(absl::Duration keepalive) {
+      this->keepalive = keepalive;
+      return *this;
+    }
+    absl::Duration keepalive = absl::ZeroDuration();
+
+    // Maximum number of git processes run at once by clone requests. Further
+    // requests wait their turn, in the order they were queued. Zero means no
+    // limit.
+    Options& set_max_parallel_clones(int max_parallel_clones) {
+      this->max_parallel_clones = max_parallel_clones;
+      return *this;
+    }
+    int max_parallel_clones =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    // Maximum sustained rate of HTTP requests, per second. Up to a second's
+    // worth of requests may be sent at once. Zero means no limit.
+    Options& set_max_requests_per_second(double max_requests_per_second) {
+      this->max_requests_per_second = max_requests_per_second;
+      return *this;
+    }
+    double max_requests_per_second = 0;
+
+    // Number of times a request throttled by the server (HTTP 429) is retried
+    // before giving up. Retries honor the server's Retry-After, and otherwise
+    // back off exponentially.
+    Options& set_max_retries(int max_retries) {
+      this->max_retries = max_retries;
+      return *this;
+    }
+    int max_retries = 3;
+
+    // Directory in which responses are persisted. Responses are not cached
+    // unless this is set.
+    Options& set_cache_directory(std::optional<std::string> cache_directory) {
+      this->cache_directory = std::move(cache_directory);
+      return *this;
+    }
+    std::optional<std::string> cache_directory;
+
+    // Time for which cached responses are served without contacting the
+    // server, keyed by endpoint. Responses for other endpoints, or those older
+    // than their TTL, are conditionally revalidated before being used.
+    Options& set_cache_ttl(std::string endpoint, absl::Duration ttl) {
+      this->cache_ttls[std::move(endpoint)] = ttl;
+      return *this;
+    }
+    absl::flat_hash_map<std::string, absl::Duration> cache_ttls = {
+        {"/rpc/v5/info", absl::Minutes(5)},
+        {"/rpc/v5/search", absl::Minutes(5)},
+    };
+
+    // Path to a local metadata index. When set, RPC requests are answered
+    // from the index, and no network requests are made at all.
+    Options& set_offline_index(std::optional<std::string> offline_index) {
+      this->offline_index = std::move(offline_index);
+      return *this;
+    }
+    std::optional<std::string> offline_index;
+
+    // Receives the timings of every HTTP request made by the client. Must
+    // outlive the client.
+    Options& set_stats(RequestStats* stats) {
+      this->stats = stats;
+      return *this;
+    }
+    RequestStats* stats = nullptr;
   };
 
-  static std::unique_ptr<Client> New(Client::Options options = {});
+  static std::unique_ptr<Client> New(Client::Options options);
 
   Client() = default;
   virtual ~Client() = default;
@@ -62,10 +180,19 @@ class Client {
   Client& operator=(Client&&) = default;
 
   // Asynchronously issue an RPC request using the REST API. The callback will
-  // be invoked when the call completes.
+  // be invoked when the call completes. The request's fields are a hint: fields
+  // outside of them may be left at their defaults, but needn't be.
   virtual void QueueRpcRequest(const RpcRequest& request,
                                RpcResponseCallback callback) = 0;
 
+  // Like QueueRpcRequest, but the packages in the response are RpcPackageViews
+  // into the response body rather than Packages of their own. The body is
+  // parsed once it has arrived in full, but far fewer allocations are made for
+  // large responses. Callers of an identical request in flight each get a view
+  // parsed from their own copy of its body.
+  virtual void QueueRpcViewRequest(const RpcRequest& request,
+                                   RpcResponseViewCallback callback) = 0;
+
   // Asynchronously issue a raw request. The callback will be invoked when the
   // call completes.
   virtual void QueueRawRequest(const HttpRequest& request,
@@ -75,6 +202,11 @@ class Client {
   virtual void QueueCloneRequest(const CloneRequest& request,
                                  CloneResponseCallback callback) = 0;
 
+  // Download a snapshot tarball, e.g. RawRequest::ForSnapshot, and extract it
+  // into the current directory as it arrives.
+  virtual void QueueSnapshotRequest(const HttpRequest& request,
+                                    CloneResponseCallback callback) = 0;
+
   // Wait for all pending requests to complete. Returns non-zero if any request
   // failed or was cancelled by a callback.
   virtual int Wait() = 0;
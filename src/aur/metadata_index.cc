@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: MIT
+#include "aur/metadata_index.hh"
+
+#include <algorithm>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+
+namespace aur {
+
+namespace {
+
+using SearchBy = SearchRequest::SearchBy;
+
+bool ContainsIgnoreCase(std::string_view haystack, std::string_view needle) {
+  return !std::ranges::search(haystack, needle, [](char a, char b) {
+            return absl::ascii_tolower(a) == absl::ascii_tolower(b);
+          }).empty();
+}
+
+bool AnyDependencyNamed(const StringListView& depstrings,
+                        std::string_view name) {
+  return absl::c_any_of(depstrings, [&](std::string_view depstring) {
+    return DependencyName(depstring) == name;
+  });
+}
+
+}  // namespace
+
+// static
+absl::Status MetadataIndex::Write(const std::string& path,
+                                  const std::vector<Package>& packages) {
+  return PackageIndex::Write(path, packages);
+}
+
+// static
+absl::StatusOr<MetadataIndex> MetadataIndex::Load(const std::string& path) {
+  auto packages = PackageIndex::Open(path);
+  if (absl::IsNotFound(packages.status())) {
+    return absl::NotFoundError(
+        absl::StrCat("metadata index not found at ", path,
+                     " (did you run 'auracle sync-metadata'?)"));
+  }
+  if (!packages.ok()) {
+    return absl::Status(
+        packages.status().code(),
+        absl::StrCat("failed to load metadata index (try re-running 'auracle "
+                     "sync-metadata'): ",
+                     packages.status().message()));
+  }
+
+  return MetadataIndex(std::move(packages).value());
+}
+
+absl::StatusOr<std::vector<PackageView>> MetadataIndex::Search(
+    SearchBy by, std::string_view term) const {
+  // Mirror the errors produced by the AUR.
+  if (by == SearchBy::INVALID) {
+    return absl::UnknownError("Incorrect by field specified.");
+  }
+  if ((by == SearchBy::NAME || by == SearchBy::NAME_DESC) && term.size() < 2) {
+    return absl::UnknownError("Query arg too small.");
+  }
+
+  // Relationships between packages are indexed, and don't need a scan.
+  switch (by) {
+    case SearchBy::PROVIDES:
+      return packages_.FindByRelation(PackageRelation::PROVIDES, term);
+    case SearchBy::DEPENDS:
+      return packages_.FindByRelation(PackageRelation::DEPENDS, term);
+    case SearchBy::MAKEDEPENDS:
+      return packages_.FindByRelation(PackageRelation::MAKEDEPENDS, term);
+    case SearchBy::CHECKDEPENDS:
+      return packages_.FindByRelation(PackageRelation::CHECKDEPENDS, term);
+    case SearchBy::OPTDEPENDS:
+      return packages_.FindByRelation(PackageRelation::OPTDEPENDS, term);
+    default:
+      break;
+  }
+
+  const auto matches = [&](const PackageView& p) {
+    switch (by) {
+      case SearchBy::NAME:
+        return ContainsIgnoreCase(p.name(), term);
+      case SearchBy::NAME_DESC:
+        return ContainsIgnoreCase(p.name(), term) ||
+               ContainsIgnoreCase(p.description(), term);
+      case SearchBy::MAINTAINER:
+        return p.maintainer() == term;
+      case SearchBy::SUBMITTER:
+        return p.submitter() == term;
+      case SearchBy::CONFLICTS:
+        return AnyDependencyNamed(p.conflicts(), term);
+      case SearchBy::REPLACES:
+        return AnyDependencyNamed(p.replaces(), term);
+      case SearchBy::KEYWORDS:
+        return absl::c_linear_search(p.keywords(), term);
+      case SearchBy::GROUPS:
+        return absl::c_linear_search(p.groups(), term);
+      case SearchBy::COMAINTAINERS:
+        return absl::c_linear_search(p.comaintainers(), term);
+      default:
+        break;
+    }
+
+    return false;
+  };
+
+  std::vector<PackageView> results;
+  for (int i = 0; i < packages_.size(); ++i) {
+    if (const PackageView package = packages_.Get(i); matches(package)) {
+      results.push_back(package);
+    }
+  }
+
+  return results;
+}
+
+}  // namespace aur
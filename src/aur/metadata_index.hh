@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_METADATA_INDEX_HH_
+#define AUR_METADATA_INDEX_HH_
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "aur/package.hh"
+#include "aur/package_index.hh"
+#include "aur/request.hh"
+
+namespace aur {
+
+// MetadataIndex answers queries about AUR packages from a local snapshot of the
+// AUR's package metadata, rather than by asking the AUR.
+class MetadataIndex {
+ public:
+  // Persists |packages| to |path|, replacing any existing index.
+  static absl::Status Write(const std::string& path,
+                            const std::vector<Package>& packages);
+
+  // Loads an index previously written to |path|. The index is memory mapped,
+  // so this is cheap regardless of the size of the index.
+  static absl::StatusOr<MetadataIndex> Load(const std::string& path);
+
+  MetadataIndex(const MetadataIndex&) = delete;
+  MetadataIndex& operator=(const MetadataIndex&) = delete;
+
+  MetadataIndex(MetadataIndex&&) = default;
+  MetadataIndex& operator=(MetadataIndex&&) = default;
+
+  std::optional<PackageView> FindByName(std::string_view name) const {
+    return packages_.FindByName(name);
+  }
+
+  // Returns packages matching |term| along the given dimension, following the
+  // same matching rules as the AUR's search endpoint.
+  absl::StatusOr<std::vector<PackageView>> Search(SearchRequest::SearchBy by,
+                                                  std::string_view term) const;
+
+  int size() const { return packages_.size(); }
+
+ private:
+  explicit MetadataIndex(PackageIndex packages)
+      : packages_(std::move(packages)) {}
+
+  PackageIndex packages_;
+};
+
+}  // namespace aur
+
+#endif  // AUR_METADATA_INDEX_HH_
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: MIT
+#include "aur/metadata_index.hh"
+
+#include <filesystem>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace fs = std::filesystem;
+
+using aur::MetadataIndex;
+using aur::Package;
+using aur::PackageView;
+using SearchBy = aur::SearchRequest::SearchBy;
+using testing::UnorderedElementsAre;
+
+class MetadataIndexTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = fs::path(testing::TempDir()) /
+            testing::UnitTest::GetInstance()->current_test_info()->name();
+
+    Package auracle;
+    auracle.name = "auracle-git";
+    auracle.description = "A flexible client for the AUR";
+    auracle.maintainer = "falconindy";
+    auracle.depends = {"pacman>=6", "libcurl.so"};
+    auracle.provides = {"auracle=1"};
+
+    Package pkgfile;
+    pkgfile.name = "pkgfile-git";
+    pkgfile.description = "a pacman .files metadata explorer";
+    pkgfile.maintainer = "falconindy";
+    pkgfile.depends = {"libarchive", "pacman"};
+
+    ASSERT_TRUE(MetadataIndex::Write(path_, {auracle, pkgfile}).ok());
+  }
+
+  void TearDown() override { fs::remove(path_); }
+
+  std::vector<std::string> Search(SearchBy by, std::string_view term) {
+    auto index = MetadataIndex::Load(path_);
+    EXPECT_TRUE(index.ok()) << index.status();
+
+    auto results = index->Search(by, term);
+    EXPECT_TRUE(results.ok()) << results.status();
+
+    std::vector<std::string> names;
+    for (const PackageView& p : *results) {
+      names.emplace_back(p.name());
+    }
+    return names;
+  }
+
+  std::string path_;
+};
+
+TEST_F(MetadataIndexTest, SearchesByNameIgnoringCase) {
+  EXPECT_THAT(Search(SearchBy::NAME, "AURA"),
+              UnorderedElementsAre("auracle-git"));
+  EXPECT_THAT(Search(SearchBy::NAME, "-git"),
+              UnorderedElementsAre("auracle-git", "pkgfile-git"));
+  EXPECT_THAT(Search(SearchBy::NAME, "flexible"), UnorderedElementsAre());
+  EXPECT_THAT(Search(SearchBy::NAME_DESC, "flexible"),
+              UnorderedElementsAre("auracle-git"));
+}
+
+TEST_F(MetadataIndexTest, SearchesDependenciesByName) {
+  EXPECT_THAT(Search(SearchBy::DEPENDS, "pacman"),
+              UnorderedElementsAre("auracle-git", "pkgfile-git"));
+  EXPECT_THAT(Search(SearchBy::DEPENDS, "pac"), UnorderedElementsAre());
+  EXPECT_THAT(Search(SearchBy::PROVIDES, "auracle"),
+              UnorderedElementsAre("auracle-git"));
+  EXPECT_THAT(Search(SearchBy::PROVIDES, "pkgfile-git"),
+              UnorderedElementsAre("pkgfile-git"));
+}
+
+TEST_F(MetadataIndexTest, SearchesByMaintainerExactly) {
+  EXPECT_THAT(Search(SearchBy::MAINTAINER, "falconindy"),
+              UnorderedElementsAre("auracle-git", "pkgfile-git"));
+  EXPECT_THAT(Search(SearchBy::MAINTAINER, "falcon"), UnorderedElementsAre());
+}
+
+TEST_F(MetadataIndexTest, RejectsShortSearchTerms) {
+  auto index = MetadataIndex::Load(path_);
+  ASSERT_TRUE(index.ok()) << index.status();
+
+  auto results = index->Search(SearchBy::NAME, "a");
+  EXPECT_EQ(results.status().message(), "Query arg too small.");
+}
+
+TEST_F(MetadataIndexTest, MissingIndexSuggestsSyncing) {
+  auto index = MetadataIndex::Load(path_ + ".missing");
+  EXPECT_TRUE(absl::IsNotFound(index.status()));
+  EXPECT_THAT(index.status().message(), testing::HasSubstr("sync-metadata"));
+}
@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: MIT
+#include "aur/offline_client.hh"
+
+#include <curl/curl.h>
+
+#include <cerrno>
+#include <deque>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "aur/metadata_index.hh"
+
+namespace aur {
+
+namespace {
+
+std::string UrlUnescape(std::string_view sv) {
+  int length;
+  char* ptr = curl_easy_unescape(nullptr, sv.data(), sv.size(), &length);
+  std::string unescaped(ptr, length);
+  curl_free(ptr);
+
+  return unescaped;
+}
+
+HttpRequest::QueryParams ParseQueryParams(std::string_view query) {
+  HttpRequest::QueryParams params;
+  for (const auto param : absl::StrSplit(query, '&', absl::SkipEmpty())) {
+    std::pair<std::string_view, std::string_view> kv =
+        absl::StrSplit(param, absl::MaxSplits('=', 1));
+    params.emplace_back(UrlUnescape(kv.first), UrlUnescape(kv.second));
+  }
+
+  return params;
+}
+
+class OfflineClient : public Client {
+ public:
+  explicit OfflineClient(std::string index_path)
+      : index_path_(std::move(index_path)) {}
+
+  OfflineClient(const OfflineClient&) = delete;
+  OfflineClient& operator=(const OfflineClient&) = delete;
+
+  OfflineClient(OfflineClient&&) = default;
+  OfflineClient& operator=(OfflineClient&&) = default;
+
+  void QueueRpcRequest(const RpcRequest& request,
+                       RpcResponseCallback callback) override {
+    pending_.push_back([this, url = request.Url(""),
+                        payload = request.Payload(),
+                        callback = std::move(callback)]() mutable {
+      return std::move(callback)(Query(url, payload));
+    });
+  }
+
+  void QueueRpcViewRequest(const RpcRequest& request,
+                           RpcResponseViewCallback callback) override {
+    pending_.push_back([this, url = request.Url(""),
+                        payload = request.Payload(),
+                        callback = std::move(callback)]() mutable {
+      auto response = Query(url, payload);
+      if (!response.ok()) {
+        return std::move(callback)(response.status());
+      }
+      return std::move(callback)(
+          RpcResponseView::FromPackages(std::move(response->packages)));
+    });
+  }
+
+  void QueueRawRequest(const HttpRequest& request,
+                       RawResponseCallback callback) override {
+    pending_.push_back(
+        [url = request.Url(""), callback = std::move(callback)]() mutable {
+          return std::move(callback)(Unavailable(url));
+        });
+  }
+
+  void QueueCloneRequest(const CloneRequest& request,
+                         CloneResponseCallback callback) override {
+    pending_.push_back(
+        [url = request.Url(""), callback = std::move(callback)]() mutable {
+          return std::move(callback)(Unavailable(url));
+        });
+  }
+
+  void QueueSnapshotRequest(const HttpRequest& request,
+                            CloneResponseCallback callback) override {
+    pending_.push_back(
+        [url = request.Url(""), callback = std::move(callback)]() mutable {
+          return std::move(callback)(Unavailable(url));
+        });
+  }
+
+  int Wait() override {
+    while (!pending_.empty()) {
+      auto request = std::move(pending_.front());
+      pending_.pop_front();
+
+      if (std::move(request)() < 0) {
+        pending_.clear();
+        return -ECANCELED;
+      }
+    }
+
+    return 0;
+  }
+
+ private:
+  using PendingRequest = absl::AnyInvocable<int() &&>;
+
+  static absl::Status Unavailable(std::string_view url) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("cannot fetch ", url, " in offline mode"));
+  }
+
+  absl::StatusOr<const MetadataIndex*> Index() {
+    if (!index_.has_value()) {
+      index_.emplace(MetadataIndex::Load(index_path_));
+    }
+
+    if (!index_->ok()) {
+      return index_->status();
+    }
+
+    return &index_->value();
+  }
+
+  // Answers the RPC request described by |url| and |payload| in the same way
+  // that the AUR would.
+  absl::StatusOr<RpcResponse> Query(std::string_view url,
+                                    std::string_view payload) {
+    auto index = Index();
+    if (!index.ok()) {
+      return index.status();
+    }
+
+    std::pair<std::string_view, std::string_view> path_and_query =
+        absl::StrSplit(url, absl::MaxSplits('?', 1));
+    auto [path, query] = path_and_query;
+
+    if (path == "/rpc/v5/info") {
+      std::vector<Package> packages;
+      absl::flat_hash_set<std::string> seen;
+      for (const auto& [key, value] : ParseQueryParams(payload)) {
+        if (key != "arg[]" || !seen.insert(value).second) {
+          continue;
+        }
+
+        if (const auto package = (*index)->FindByName(value)) {
+          packages.push_back(package->ToPackage());
+        }
+      }
+
+      return RpcResponse(std::move(packages));
+    }
+
+    if (absl::ConsumePrefix(&path, "/rpc/v5/search/")) {
+      std::string by = "name-desc";
+      for (auto& [key, value] : ParseQueryParams(query)) {
+        if (key == "by") {
+          by = std::move(value);
+        }
+      }
+
+      auto results = (*index)->Search(SearchRequest::ParseSearchBy(by),
+                                      UrlUnescape(path));
+      if (!results.ok()) {
+        return results.status();
+      }
+
+      std::vector<Package> packages;
+      packages.reserve(results->size());
+      for (const auto& package : *results) {
+        packages.push_back(package.ToPackage());
+      }
+
+      return RpcResponse(std::move(packages));
+    }
+
+    return Unavailable(url);
+  }
+
+  std::string index_path_;
+  std::optional<absl::StatusOr<MetadataIndex>> index_;
+
+  std::deque<PendingRequest> pending_;
+};
+
+}  // namespace
+
+std::unique_ptr<Client> NewOfflineClient(std::string index_path) {
+  return std::make_unique<OfflineClient>(std::move(index_path));
+}
+
+}  // namespace aur
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_OFFLINE_CLIENT_HH_
+#define AUR_OFFLINE_CLIENT_HH_
+
+#include <memory>
+#include <string>
+
+#include "aur/client.hh"
+
+namespace aur {
+
+// Returns a Client which answers RPC requests from the metadata index at
+// |index_path| rather than by asking the AUR. Requests which can't be answered
+// from the index fail, and no network requests are ever made.
+std::unique_ptr<Client> NewOfflineClient(std::string index_path);
+
+}  // namespace aur
+
+#endif  // AUR_OFFLINE_CLIENT_HH_
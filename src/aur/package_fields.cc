@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+#include "aur/package_fields.hh"
+
+#include "absl/strings/ascii.h"
+
+namespace aur {
+
+namespace {
+
+struct FieldKey {
+  std::string_view key;
+  PackageField field;
+};
+
+constexpr FieldKey kFieldKeys[] = {
+    {"CheckDepends", PackageField::CHECKDEPENDS},
+    {"CoMaintainers", PackageField::COMAINTAINERS},
+    {"Conflicts", PackageField::CONFLICTS},
+    {"Depends", PackageField::DEPENDS},
+    {"Description", PackageField::DESCRIPTION},
+    {"FirstSubmitted", PackageField::SUBMITTED},
+    {"Groups", PackageField::GROUPS},
+    {"ID", PackageField::PACKAGE_ID},
+    {"Keywords", PackageField::KEYWORDS},
+    {"LastModified", PackageField::MODIFIED},
+    {"License", PackageField::LICENSES},
+    {"Maintainer", PackageField::MAINTAINER},
+    {"MakeDepends", PackageField::MAKEDEPENDS},
+    {"Name", PackageField::NAME},
+    {"NumVotes", PackageField::VOTES},
+    {"OptDepends", PackageField::OPTDEPENDS},
+    {"OutOfDate", PackageField::OUT_OF_DATE},
+    {"PackageBase", PackageField::PKGBASE},
+    {"PackageBaseID", PackageField::PKGBASE_ID},
+    {"Popularity", PackageField::POPULARITY},
+    {"Provides", PackageField::PROVIDES},
+    {"Replaces", PackageField::REPLACES},
+    {"Submitter", PackageField::SUBMITTER},
+    {"URL", PackageField::UPSTREAM_URL},
+    {"URLPath", PackageField::AUR_URLPATH},
+    {"Version", PackageField::VERSION},
+};
+
+static_assert(std::size(kFieldKeys) == kPackageFieldCount);
+
+}  // namespace
+
+bool PackageFields::ContainsKey(std::string_view key) const {
+  for (const auto& [k, field] : kFieldKeys) {
+    if (k == key) {
+      return Contains(field);
+    }
+  }
+  return false;
+}
+
+void PackageFieldFilter::Append(std::string_view bytes, std::string* out) {
+  // Bytes are copied in runs starting at |begin|, unless they belong to a
+  // member which is being skipped.
+  size_t begin = 0;
+  const auto flush = [&](size_t end) {
+    if (!skipping_) {
+      out->append(bytes.substr(begin, end - begin));
+    }
+    begin = end;
+  };
+
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    const char c = bytes[i];
+
+    if (in_string_) {
+      if (escaped_) {
+        escaped_ = false;
+      } else if (c == '\\') {
+        escaped_ = true;
+      } else if (c == '"') {
+        in_string_ = false;
+      }
+      continue;
+    }
+
+    switch (c) {
+      case '"':
+        in_string_ = true;
+        break;
+      case '{':
+      case '[':
+        if (++depth_ == 1) {
+          flush(i + 1);
+          member_start_ = out->size();
+        }
+        break;
+      case '}':
+      case ']':
+        if (--depth_ == 0) {
+          flush(i);
+          skipping_ = false;
+
+          // A skipped last member leaves its separator behind.
+          out->resize(absl::StripTrailingAsciiWhitespace(*out).size());
+          if (!out->empty() && out->back() == ',') {
+            out->pop_back();
+          }
+        }
+        break;
+      case ':':
+        if (depth_ == 1) {
+          flush(i);
+
+          std::string_view key = absl::StripAsciiWhitespace(
+              std::string_view(*out).substr(member_start_));
+          if (key.size() < 2 || !key.starts_with('"') ||
+              !key.ends_with('"') ||
+              !fields_.ContainsKey(key.substr(1, key.size() - 2))) {
+            out->resize(member_start_);
+            skipping_ = true;
+          }
+        }
+        break;
+      case ',':
+        if (depth_ == 1) {
+          flush(i);
+          // The separator goes with a skipped member.
+          if (skipping_) {
+            skipping_ = false;
+          } else {
+            out->push_back(',');
+          }
+          begin = i + 1;
+          member_start_ = out->size();
+        }
+        break;
+    }
+  }
+
+  flush(bytes.size());
+}
+
+}  // namespace aur
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_PACKAGE_FIELDS_HH_
+#define AUR_PACKAGE_FIELDS_HH_
+
+#include <bitset>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace aur {
+
+// The fields of a Package, as sent by the RPC interface.
+enum class PackageField : int8_t {
+  NAME,
+  DESCRIPTION,
+  SUBMITTER,
+  MAINTAINER,
+  PKGBASE,
+  UPSTREAM_URL,
+  AUR_URLPATH,
+  VERSION,
+  PACKAGE_ID,
+  PKGBASE_ID,
+  VOTES,
+  POPULARITY,
+  OUT_OF_DATE,
+  SUBMITTED,
+  MODIFIED,
+  CONFLICTS,
+  GROUPS,
+  KEYWORDS,
+  LICENSES,
+  OPTDEPENDS,
+  PROVIDES,
+  REPLACES,
+  COMAINTAINERS,
+  DEPENDS,
+  MAKEDEPENDS,
+  CHECKDEPENDS,
+};
+
+inline constexpr int kPackageFieldCount = 26;
+
+// PackageFields is the set of fields which a caller needs from the packages
+// in an RPC response. Fields outside of the set aren't decoded, and are left
+// at their defaults.
+class PackageFields {
+ public:
+  static PackageFields All() {
+    PackageFields fields;
+    fields.bits_.set();
+    return fields;
+  }
+
+  // The IDs are always included, since packages are told apart by them.
+  PackageFields(std::initializer_list<PackageField> fields) {
+    Add(PackageField::PACKAGE_ID).Add(PackageField::PKGBASE_ID);
+    for (const auto field : fields) {
+      Add(field);
+    }
+  }
+
+  PackageFields(const PackageFields&) = default;
+  PackageFields& operator=(const PackageFields&) = default;
+
+  PackageFields(PackageFields&&) = default;
+  PackageFields& operator=(PackageFields&&) = default;
+
+  PackageFields& Add(PackageField field) {
+    bits_.set(static_cast<int>(field));
+    return *this;
+  }
+
+  bool Contains(PackageField field) const {
+    return bits_.test(static_cast<int>(field));
+  }
+
+  // Whether the member of a package named |key| in an RPC response is wanted.
+  // Members which don't correspond to a field never are.
+  bool ContainsKey(std::string_view key) const;
+
+  bool all() const { return bits_.all(); }
+
+  friend bool operator==(const PackageFields& a, const PackageFields& b) {
+    return a.bits_ == b.bits_;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const PackageFields& fields) {
+    return H::combine(std::move(h), fields.bits_.to_ulong());
+  }
+
+ private:
+  PackageFields() = default;
+
+  std::bitset<kPackageFieldCount> bits_;
+};
+
+// PackageFieldFilter drops the unwanted members from the JSON objects of
+// packages, so that the decoder never sees them. Input may be given in chunks
+// of any size, and may hold any number of consecutive objects.
+class PackageFieldFilter {
+ public:
+  explicit PackageFieldFilter(PackageFields fields)
+      : fields_(std::move(fields)) {}
+
+  PackageFieldFilter(const PackageFieldFilter&) = delete;
+  PackageFieldFilter& operator=(const PackageFieldFilter&) = delete;
+
+  PackageFieldFilter(PackageFieldFilter&&) = default;
+  PackageFieldFilter& operator=(PackageFieldFilter&&) = default;
+
+  // Appends |bytes|, less any unwanted members, to |out|. The same |out| must
+  // be given until the current object is complete.
+  void Append(std::string_view bytes, std::string* out);
+
+ private:
+  PackageFields fields_;
+
+  int depth_ = 0;
+  bool in_string_ = false;
+  bool escaped_ = false;
+  bool skipping_ = false;
+
+  // Where the member currently being received starts in the output.
+  size_t member_start_ = 0;
+};
+
+}  // namespace aur
+
+#endif  // AUR_PACKAGE_FIELDS_HH_
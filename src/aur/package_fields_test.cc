@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+#include "aur/package_fields.hh"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using aur::PackageField;
+using aur::PackageFieldFilter;
+using aur::PackageFields;
+
+namespace {
+
+std::string Filter(const PackageFields& fields, std::string_view json,
+                   size_t chunk_size = std::string_view::npos) {
+  PackageFieldFilter filter(fields);
+  std::string out;
+  for (size_t i = 0; i < json.size(); i += chunk_size) {
+    filter.Append(json.substr(i, chunk_size), &out);
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(PackageFieldsTest, AlwaysContainsIds) {
+  const PackageFields fields({PackageField::NAME});
+
+  EXPECT_TRUE(fields.Contains(PackageField::NAME));
+  EXPECT_TRUE(fields.Contains(PackageField::PACKAGE_ID));
+  EXPECT_TRUE(fields.Contains(PackageField::PKGBASE_ID));
+  EXPECT_FALSE(fields.Contains(PackageField::DEPENDS));
+  EXPECT_FALSE(fields.all());
+
+  EXPECT_TRUE(fields.ContainsKey("Name"));
+  EXPECT_TRUE(fields.ContainsKey("ID"));
+  EXPECT_FALSE(fields.ContainsKey("Depends"));
+  EXPECT_FALSE(fields.ContainsKey("NotAField"));
+
+  EXPECT_TRUE(PackageFields::All().all());
+  EXPECT_TRUE(PackageFields::All().ContainsKey("CheckDepends"));
+  EXPECT_FALSE(PackageFields::All().ContainsKey("NotAField"));
+}
+
+TEST(PackageFieldsTest, FiltersMembers) {
+  const PackageFields fields({PackageField::NAME, PackageField::VERSION});
+
+  EXPECT_EQ(Filter(fields, R"({"ID":1,"Name":"a","Depends":["b"],)"
+                           R"("Version":"1-1"})"),
+            R"({"ID":1,"Name":"a","Version":"1-1"})");
+
+  // Skipped members first and last, and nothing but skipped members.
+  EXPECT_EQ(Filter(fields, R"({"Depends":["b"],"Name":"a","License":null})"),
+            R"({"Name":"a"})");
+  EXPECT_EQ(Filter(fields, R"({"Depends":["b"],"Provides":[]})"), "{}");
+  EXPECT_EQ(Filter(fields, "{}"), "{}");
+}
+
+TEST(PackageFieldsTest, FiltersAwkwardInput) {
+  const PackageFields fields({PackageField::NAME});
+
+  constexpr std::string_view kJson = R"(  {
+      "Description" : "tricky \"}, \"Name\": [" ,
+      "Name" : "a,b:c{d}",
+      "Unknown": {"Name": [1, {"x": "]"}]},
+      "ID": 7
+    }{"Name":"second","Keywords":["x"]})";
+  constexpr std::string_view kWant = R"(  {
+      "Name" : "a,b:c{d}",
+      "ID": 7}{"Name":"second"})";
+
+  for (size_t chunk_size : {size_t{1}, size_t{3}, size_t{7}, kJson.size()}) {
+    EXPECT_EQ(Filter(fields, kJson, chunk_size), kWant) << chunk_size;
+  }
+}
+
+TEST(PackageFieldsTest, KeepsEverythingWhenAllFieldsAreWanted) {
+  constexpr std::string_view kJson =
+      R"({"ID":1,"Name":"a","Depends":["b"],"Unknown":true})";
+
+  // Unknown members are dropped regardless, as nothing would decode them.
+  EXPECT_EQ(Filter(PackageFields::All(), kJson),
+            R"({"ID":1,"Name":"a","Depends":["b"]})");
+}
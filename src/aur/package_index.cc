@@ -0,0 +1,482 @@
+// SPDX-License-Identifier: MIT
+#include "aur/package_index.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+
+namespace fs = std::filesystem;
+
+namespace aur {
+
+namespace format = package_index_format;
+
+static_assert(std::is_trivially_copyable_v<format::Header>);
+static_assert(std::is_trivially_copyable_v<format::Record>);
+static_assert(sizeof(format::Header) % 8 == 0);
+static_assert(sizeof(format::Record) % 8 == 0);
+
+namespace {
+
+constexpr uint64_t Align(uint64_t offset) { return (offset + 7) & ~7; }
+
+const std::vector<std::string>& RelatedNames(const Package& p,
+                                             PackageRelation relation) {
+  switch (relation) {
+    case PackageRelation::PROVIDES:
+      return p.provides;
+    case PackageRelation::DEPENDS:
+      return p.depends;
+    case PackageRelation::MAKEDEPENDS:
+      return p.makedepends;
+    case PackageRelation::CHECKDEPENDS:
+      return p.checkdepends;
+    case PackageRelation::OPTDEPENDS:
+      return p.optdepends;
+  }
+
+  std::abort();
+}
+
+class IndexBuilder {
+ public:
+  absl::Status Add(const Package& p) {
+    format::Record& r = records_.emplace_back();
+
+    r.name = Intern(p.name);
+    r.description = Intern(p.description);
+    r.submitter = Intern(p.submitter);
+    r.maintainer = Intern(p.maintainer);
+    r.pkgbase = Intern(p.pkgbase);
+    r.upstream_url = Intern(p.upstream_url);
+    r.aur_urlpath = Intern(p.aur_urlpath);
+    r.version = Intern(p.version);
+
+    r.package_id = p.package_id;
+    r.pkgbase_id = p.pkgbase_id;
+    r.votes = p.votes;
+    r.reserved = 0;
+    r.popularity = p.popularity;
+
+    r.out_of_date = absl::ToUnixSeconds(p.out_of_date);
+    r.submitted = absl::ToUnixSeconds(p.submitted);
+    r.modified = absl::ToUnixSeconds(p.modified);
+
+    r.conflicts = InternList(p.conflicts);
+    r.groups = InternList(p.groups);
+    r.keywords = InternList(p.keywords);
+    r.licenses = InternList(p.licenses);
+    r.optdepends = InternList(p.optdepends);
+    r.provides = InternList(p.provides);
+    r.replaces = InternList(p.replaces);
+    r.comaintainers = InternList(p.comaintainers);
+    r.depends = InternList(p.depends);
+    r.makedepends = InternList(p.makedepends);
+    r.checkdepends = InternList(p.checkdepends);
+
+    const uint32_t record = records_.size() - 1;
+    Post(PackageRelation::PROVIDES, p.name, record);
+    for (int i = 0; i < format::kRelationCount; ++i) {
+      const auto relation = static_cast<PackageRelation>(i);
+      for (const auto& depstring : RelatedNames(p, relation)) {
+        Post(relation, DependencyName(depstring), record);
+      }
+    }
+
+    if (strings_.size() > std::numeric_limits<uint32_t>::max() ||
+        list_entries_.size() > std::numeric_limits<uint32_t>::max()) {
+      return absl::ResourceExhaustedError("too much data for a package index");
+    }
+
+    return absl::OkStatus();
+  }
+
+  std::string Finish(const std::vector<Package>& packages) {
+    std::vector<uint32_t> name_index(records_.size());
+    std::iota(name_index.begin(), name_index.end(), 0);
+    std::stable_sort(name_index.begin(), name_index.end(),
+                     [&](uint32_t a, uint32_t b) {
+                       return packages[a].name < packages[b].name;
+                     });
+
+    // Flatten the reverse indexes before laying anything out, as their keys
+    // add to the string table.
+    struct ReverseIndex {
+      std::vector<format::ReverseIndexKey> keys;
+      std::vector<uint32_t> postings;
+    };
+    std::vector<ReverseIndex> reverse_indexes(format::kRelationCount);
+    for (int i = 0; i < format::kRelationCount; ++i) {
+      std::vector<std::string_view> names;
+      names.reserve(postings_[i].size());
+      for (const auto& [name, _] : postings_[i]) {
+        names.push_back(name);
+      }
+      std::sort(names.begin(), names.end());
+
+      auto& index = reverse_indexes[i];
+      index.keys.reserve(names.size());
+      for (const auto name : names) {
+        const auto& records = postings_[i][name];
+        index.keys.push_back({Intern(name),
+                              static_cast<uint32_t>(index.postings.size()),
+                              static_cast<uint32_t>(records.size())});
+        index.postings.insert(index.postings.end(), records.begin(),
+                              records.end());
+      }
+    }
+
+    format::Header header = {};
+    std::memcpy(header.magic, format::kMagic, sizeof(header.magic));
+    header.version = format::kVersion;
+    header.byte_order = format::kByteOrderMark;
+    header.package_count = records_.size();
+    header.list_entry_count = list_entries_.size();
+    header.string_table_size = strings_.size();
+
+    header.records_offset = Align(sizeof(header));
+    header.list_entries_offset = Align(
+        header.records_offset + records_.size() * sizeof(format::Record));
+    header.name_index_offset =
+        Align(header.list_entries_offset +
+              list_entries_.size() * sizeof(format::StringRef));
+
+    uint64_t offset =
+        header.name_index_offset + name_index.size() * sizeof(uint32_t);
+    for (int i = 0; i < format::kRelationCount; ++i) {
+      auto& ref = header.reverse_indexes[i];
+      const auto& index = reverse_indexes[i];
+
+      ref.key_count = index.keys.size();
+      ref.posting_count = index.postings.size();
+      ref.keys_offset = Align(offset);
+      ref.postings_offset =
+          Align(ref.keys_offset +
+                index.keys.size() * sizeof(format::ReverseIndexKey));
+      offset = ref.postings_offset + index.postings.size() * sizeof(uint32_t);
+    }
+
+    header.string_table_offset = Align(offset);
+
+    std::string data(header.string_table_offset + strings_.size(), '\0');
+    const auto put = [&data](uint64_t offset, const void* src, size_t size) {
+      if (size > 0) {
+        std::memcpy(data.data() + offset, src, size);
+      }
+    };
+
+    put(0, &header, sizeof(header));
+    put(header.records_offset, records_.data(),
+        records_.size() * sizeof(format::Record));
+    put(header.list_entries_offset, list_entries_.data(),
+        list_entries_.size() * sizeof(format::StringRef));
+    put(header.name_index_offset, name_index.data(),
+        name_index.size() * sizeof(uint32_t));
+    for (int i = 0; i < format::kRelationCount; ++i) {
+      const auto& ref = header.reverse_indexes[i];
+      const auto& index = reverse_indexes[i];
+
+      put(ref.keys_offset, index.keys.data(),
+          index.keys.size() * sizeof(format::ReverseIndexKey));
+      put(ref.postings_offset, index.postings.data(),
+          index.postings.size() * sizeof(uint32_t));
+    }
+    put(header.string_table_offset, strings_.data(), strings_.size());
+
+    return data;
+  }
+
+ private:
+  // Package metadata is highly repetitive (think of how many packages depend
+  // on "glibc"), so every distinct string is only stored once.
+  format::StringRef Intern(std::string_view s) {
+    auto [iter, inserted] = interned_.try_emplace(s);
+    if (inserted) {
+      iter->second = {static_cast<uint32_t>(strings_.size()),
+                      static_cast<uint32_t>(s.size())};
+      strings_.append(s);
+    }
+
+    return iter->second;
+  }
+
+  format::ListRef InternList(const std::vector<std::string>& list) {
+    format::ListRef ref = {static_cast<uint32_t>(list_entries_.size()),
+                           static_cast<uint32_t>(list.size())};
+    for (const auto& s : list) {
+      list_entries_.push_back(Intern(s));
+    }
+
+    return ref;
+  }
+
+  void Post(PackageRelation relation, std::string_view name, uint32_t record) {
+    auto& records = postings_[static_cast<int>(relation)][name];
+    if (records.empty() || records.back() != record) {
+      records.push_back(record);
+    }
+  }
+
+  // Keys point into the packages being written, which outlive the builder.
+  absl::flat_hash_map<std::string_view, format::StringRef> interned_;
+  absl::flat_hash_map<std::string_view, std::vector<uint32_t>>
+      postings_[format::kRelationCount];
+  std::string strings_;
+  std::vector<format::StringRef> list_entries_;
+  std::vector<format::Record> records_;
+};
+
+absl::Status Validate(const format::Header& header, size_t size) {
+  if (std::memcmp(header.magic, format::kMagic, sizeof(header.magic)) != 0) {
+    return absl::DataLossError("not a package index");
+  }
+
+  if (header.byte_order != format::kByteOrderMark) {
+    return absl::DataLossError("package index has foreign byte order");
+  }
+
+  if (header.version != format::kVersion) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("unsupported package index version ", header.version,
+                     " (expected ", format::kVersion, ")"));
+  }
+
+  const auto section_fits = [size](uint64_t offset, uint64_t count,
+                                   uint64_t width) {
+    return offset % 8 == 0 && offset <= size &&
+           count <= (size - offset) / width;
+  };
+
+  if (!section_fits(header.records_offset, header.package_count,
+                    sizeof(format::Record)) ||
+      !section_fits(header.list_entries_offset, header.list_entry_count,
+                    sizeof(format::StringRef)) ||
+      !section_fits(header.name_index_offset, header.package_count,
+                    sizeof(uint32_t)) ||
+      !section_fits(header.string_table_offset, header.string_table_size, 1)) {
+    return absl::DataLossError("package index is truncated");
+  }
+
+  for (const auto& ref : header.reverse_indexes) {
+    if (!section_fits(ref.keys_offset, ref.key_count,
+                      sizeof(format::ReverseIndexKey)) ||
+        !section_fits(ref.postings_offset, ref.posting_count,
+                      sizeof(uint32_t))) {
+      return absl::DataLossError("package index is truncated");
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::string_view DependencyName(std::string_view depstring) {
+  return depstring.substr(0, depstring.find_first_of("<>=:"));
+}
+
+std::vector<std::string> StringListView::ToVector() const {
+  return std::vector<std::string>(begin(), end());
+}
+
+Package PackageView::ToPackage() const {
+  Package p;
+
+  p.name = name();
+  p.description = description();
+  p.submitter = submitter();
+  p.maintainer = maintainer();
+  p.pkgbase = pkgbase();
+  p.upstream_url = upstream_url();
+  p.aur_urlpath = aur_urlpath();
+  p.version = version();
+
+  p.package_id = package_id();
+  p.pkgbase_id = pkgbase_id();
+  p.votes = votes();
+  p.popularity = popularity();
+
+  p.out_of_date = out_of_date();
+  p.submitted = submitted();
+  p.modified = modified();
+
+  p.conflicts = conflicts().ToVector();
+  p.groups = groups().ToVector();
+  p.keywords = keywords().ToVector();
+  p.licenses = licenses().ToVector();
+  p.optdepends = optdepends().ToVector();
+  p.provides = provides().ToVector();
+  p.replaces = replaces().ToVector();
+  p.comaintainers = comaintainers().ToVector();
+  p.depends = depends().ToVector();
+  p.makedepends = makedepends().ToVector();
+  p.checkdepends = checkdepends().ToVector();
+
+  return p;
+}
+
+// static
+absl::Status PackageIndex::Write(const std::string& path,
+                                 const std::vector<Package>& packages) {
+  if (packages.size() > std::numeric_limits<uint32_t>::max()) {
+    return absl::ResourceExhaustedError(
+        "too many packages for a package index");
+  }
+
+  IndexBuilder builder;
+  for (const auto& p : packages) {
+    if (auto status = builder.Add(p); !status.ok()) {
+      return status;
+    }
+  }
+  const std::string data = builder.Finish(packages);
+
+  std::error_code ec;
+  if (const auto dir = fs::path(path).parent_path(); !dir.empty()) {
+    fs::create_directories(dir, ec);
+    if (ec.value() != 0) {
+      return absl::InternalError(absl::StrCat("failed to create directory ",
+                                              dir.string(), ": ",
+                                              ec.message()));
+    }
+  }
+
+  const std::string tmppath = absl::StrCat(path, ".", getpid());
+
+  std::ofstream file(tmppath, std::ios::binary | std::ios::trunc);
+  file.write(data.data(), data.size());
+  file.close();
+
+  if (!file) {
+    fs::remove(tmppath, ec);
+    return absl::InternalError(absl::StrCat("failed to write ", tmppath));
+  }
+
+  fs::rename(tmppath, path, ec);
+  if (ec.value() != 0) {
+    fs::remove(tmppath, ec);
+    return absl::InternalError(
+        absl::StrCat("failed to write ", path, ": ", ec.message()));
+  }
+
+  return absl::OkStatus();
+}
+
+// static
+absl::StatusOr<PackageIndex> PackageIndex::Open(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    const int err = errno;
+    return absl::ErrnoToStatus(err, absl::StrCat("failed to open ", path));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    const int err = errno;
+    close(fd);
+    return absl::ErrnoToStatus(err, absl::StrCat("failed to stat ", path));
+  }
+
+  const size_t size = st.st_size;
+  if (size < sizeof(format::Header)) {
+    close(fd);
+    return absl::DataLossError(absl::StrCat(path, ": not a package index"));
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int err = errno;
+  close(fd);
+  if (data == MAP_FAILED) {
+    return absl::ErrnoToStatus(err, absl::StrCat("failed to map ", path));
+  }
+
+  PackageIndex index(data, size);
+  if (auto status = Validate(index.header(), size); !status.ok()) {
+    return absl::Status(status.code(),
+                        absl::StrCat(path, ": ", status.message()));
+  }
+
+  return index;
+}
+
+PackageIndex::~PackageIndex() {
+  if (data_ != nullptr) {
+    munmap(const_cast<void*>(data_), size_);
+  }
+}
+
+PackageIndex::PackageIndex(PackageIndex&& other)
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+PackageIndex& PackageIndex::operator=(PackageIndex&& other) {
+  if (this != &other) {
+    if (data_ != nullptr) {
+      munmap(const_cast<void*>(data_), size_);
+    }
+
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+
+  return *this;
+}
+
+std::optional<PackageView> PackageIndex::FindByName(
+    std::string_view name) const {
+  const uint32_t* first = Section<uint32_t>(header().name_index_offset);
+  const uint32_t* last = first + size();
+
+  const auto* iter = std::lower_bound(
+      first, last, name, [this](uint32_t i, std::string_view n) {
+        return String(records()[i].name) < n;
+      });
+  if (iter == last || String(records()[*iter].name) != name) {
+    return std::nullopt;
+  }
+
+  return Get(*iter);
+}
+
+std::vector<PackageView> PackageIndex::FindByRelation(
+    PackageRelation relation, std::string_view name) const {
+  const auto& ref = header().reverse_indexes[static_cast<int>(relation)];
+  const auto* first = Section<format::ReverseIndexKey>(ref.keys_offset);
+  const auto* last = first + ref.key_count;
+
+  const auto* key = std::lower_bound(
+      first, last, name,
+      [this](const format::ReverseIndexKey& k, std::string_view n) {
+        return String(k.name) < n;
+      });
+  if (key == last || String(key->name) != name) {
+    return {};
+  }
+
+  const uint32_t* postings = Section<uint32_t>(ref.postings_offset);
+
+  std::vector<PackageView> packages;
+  packages.reserve(key->size);
+  for (uint32_t i = key->begin; i < key->begin + key->size; ++i) {
+    packages.push_back(Get(postings[i]));
+  }
+
+  return packages;
+}
+
+}  // namespace aur
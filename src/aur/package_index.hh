@@ -0,0 +1,378 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_PACKAGE_INDEX_HH_
+#define AUR_PACKAGE_INDEX_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "aur/package.hh"
+
+namespace aur {
+
+// Relationships between packages which a PackageIndex can answer in reverse,
+// i.e. from the name on the far side of the relationship back to the packages
+// which declare it. Providers of a name include the package by that name.
+enum class PackageRelation : int {
+  PROVIDES,
+  DEPENDS,
+  MAKEDEPENDS,
+  CHECKDEPENDS,
+  OPTDEPENDS,
+};
+
+// Returns the name portion of a depstring, e.g. "foo" for "foo>=1.0" or
+// "foo: optional support for foo".
+std::string_view DependencyName(std::string_view depstring);
+
+// On-disk layout of a PackageIndex. Everything is stored in native byte order;
+// the index is a local cache and is not meant to be portable across machines.
+//
+//   Header
+//   Record[package_count]          fixed width, in the order given to Write
+//   StringRef[list_entry_count]    elements of all string lists
+//   uint32_t[package_count]        record numbers, sorted by package name
+//   for each PackageRelation:
+//     ReverseIndexKey[key_count]   sorted by name
+//     uint32_t[posting_count]      record numbers, ascending for each key
+//   char[string_table_size]        deduplicated, not NUL terminated
+//
+// All sections start on an 8 byte boundary. Open only checks that the sections
+// lie within the file: indexes are written atomically by Write, and their
+// contents are trusted.
+namespace package_index_format {
+
+inline constexpr char kMagic[8] = {'A', 'U', 'R', 'I', 'D', 'X', '\0', '\0'};
+inline constexpr uint32_t kVersion = 2;
+inline constexpr uint32_t kByteOrderMark = 0x01020304;
+inline constexpr int kRelationCount = 5;
+
+struct StringRef {
+  uint32_t offset;
+  uint32_t size;
+};
+
+struct ListRef {
+  uint32_t begin;
+  uint32_t size;
+};
+
+struct ReverseIndexKey {
+  StringRef name;
+  uint32_t begin;
+  uint32_t size;
+};
+
+struct ReverseIndexRef {
+  uint64_t keys_offset;
+  uint64_t postings_offset;
+  uint32_t key_count;
+  uint32_t posting_count;
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+
+  uint32_t package_count;
+  uint32_t list_entry_count;
+  uint64_t string_table_size;
+
+  uint64_t records_offset;
+  uint64_t list_entries_offset;
+  uint64_t name_index_offset;
+  uint64_t string_table_offset;
+
+  ReverseIndexRef reverse_indexes[kRelationCount];
+};
+
+struct Record {
+  StringRef name;
+  StringRef description;
+  StringRef submitter;
+  StringRef maintainer;
+  StringRef pkgbase;
+  StringRef upstream_url;
+  StringRef aur_urlpath;
+  StringRef version;
+
+  int32_t package_id;
+  int32_t pkgbase_id;
+  int32_t votes;
+  uint32_t reserved;
+  double popularity;
+
+  int64_t out_of_date;
+  int64_t submitted;
+  int64_t modified;
+
+  ListRef conflicts;
+  ListRef groups;
+  ListRef keywords;
+  ListRef licenses;
+  ListRef optdepends;
+  ListRef provides;
+  ListRef replaces;
+  ListRef comaintainers;
+  ListRef depends;
+  ListRef makedepends;
+  ListRef checkdepends;
+};
+
+}  // namespace package_index_format
+
+class PackageIndex;
+
+// A read-only list of strings stored in a PackageIndex.
+class StringListView {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::string_view;
+
+    Iterator() = default;
+
+    std::string_view operator*() const;
+    std::string_view operator[](difference_type n) const {
+      return *(*this + n);
+    }
+
+    Iterator& operator++() {
+      ++ref_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator prev = *this;
+      ++ref_;
+      return prev;
+    }
+    Iterator& operator--() {
+      --ref_;
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator prev = *this;
+      --ref_;
+      return prev;
+    }
+    Iterator& operator+=(difference_type n) {
+      ref_ += n;
+      return *this;
+    }
+    Iterator& operator-=(difference_type n) {
+      ref_ -= n;
+      return *this;
+    }
+
+    friend Iterator operator+(Iterator it, difference_type n) {
+      return it += n;
+    }
+    friend Iterator operator+(difference_type n, Iterator it) {
+      return it += n;
+    }
+    friend Iterator operator-(Iterator it, difference_type n) {
+      return it -= n;
+    }
+    friend difference_type operator-(const Iterator& a, const Iterator& b) {
+      return a.ref_ - b.ref_;
+    }
+
+    friend bool operator==(const Iterator& a, const Iterator& b) {
+      return a.ref_ == b.ref_;
+    }
+    friend auto operator<=>(const Iterator& a, const Iterator& b) {
+      return a.ref_ <=> b.ref_;
+    }
+
+   private:
+    friend class StringListView;
+
+    Iterator(const PackageIndex* index,
+             const package_index_format::StringRef* ref)
+        : index_(index), ref_(ref) {}
+
+    const PackageIndex* index_ = nullptr;
+    const package_index_format::StringRef* ref_ = nullptr;
+  };
+
+  using value_type = std::string_view;
+  using size_type = size_t;
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+
+  Iterator begin() const { return Iterator(index_, refs_); }
+  Iterator end() const { return Iterator(index_, refs_ + size_); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  std::string_view operator[](size_t i) const { return begin()[i]; }
+
+  std::vector<std::string> ToVector() const;
+
+ private:
+  friend class PackageView;
+
+  StringListView(const PackageIndex* index,
+                 const package_index_format::StringRef* refs, size_t size)
+      : index_(index), refs_(refs), size_(size) {}
+
+  const PackageIndex* index_;
+  const package_index_format::StringRef* refs_;
+  size_t size_;
+};
+
+// A read-only view of a package stored in a PackageIndex, mirroring the fields
+// of aur::Package. Views are cheap to copy and remain valid for as long as the
+// index that they came from.
+class PackageView {
+ public:
+  std::string_view name() const { return String(record_->name); }
+  std::string_view description() const { return String(record_->description); }
+  std::string_view submitter() const { return String(record_->submitter); }
+  std::string_view maintainer() const { return String(record_->maintainer); }
+  std::string_view pkgbase() const { return String(record_->pkgbase); }
+  std::string_view upstream_url() const {
+    return String(record_->upstream_url);
+  }
+  std::string_view aur_urlpath() const { return String(record_->aur_urlpath); }
+  std::string_view version() const { return String(record_->version); }
+
+  int package_id() const { return record_->package_id; }
+  int pkgbase_id() const { return record_->pkgbase_id; }
+  int votes() const { return record_->votes; }
+  double popularity() const { return record_->popularity; }
+
+  absl::Time out_of_date() const {
+    return absl::FromUnixSeconds(record_->out_of_date);
+  }
+  absl::Time submitted() const {
+    return absl::FromUnixSeconds(record_->submitted);
+  }
+  absl::Time modified() const {
+    return absl::FromUnixSeconds(record_->modified);
+  }
+
+  StringListView conflicts() const { return List(record_->conflicts); }
+  StringListView groups() const { return List(record_->groups); }
+  StringListView keywords() const { return List(record_->keywords); }
+  StringListView licenses() const { return List(record_->licenses); }
+  StringListView optdepends() const { return List(record_->optdepends); }
+  StringListView provides() const { return List(record_->provides); }
+  StringListView replaces() const { return List(record_->replaces); }
+  StringListView comaintainers() const { return List(record_->comaintainers); }
+  StringListView depends() const { return List(record_->depends); }
+  StringListView makedepends() const { return List(record_->makedepends); }
+  StringListView checkdepends() const { return List(record_->checkdepends); }
+
+  // Copies the viewed package out of the index.
+  Package ToPackage() const;
+
+ private:
+  friend class PackageIndex;
+
+  PackageView(const PackageIndex* index,
+              const package_index_format::Record* record)
+      : index_(index), record_(record) {}
+
+  std::string_view String(package_index_format::StringRef ref) const;
+  StringListView List(package_index_format::ListRef ref) const;
+
+  const PackageIndex* index_;
+  const package_index_format::Record* record_;
+};
+
+// PackageIndex is a memory mapped, read-only table of packages. Opening an
+// index costs a single mmap and validation of its header; package data is
+// paged in lazily as it's accessed and never copied onto the heap unless asked
+// for.
+class PackageIndex {
+ public:
+  // Serializes |packages| to |path| in the format understood by Open,
+  // replacing any existing file.
+  static absl::Status Write(const std::string& path,
+                            const std::vector<Package>& packages);
+
+  // Maps the index at |path| into memory.
+  static absl::StatusOr<PackageIndex> Open(const std::string& path);
+
+  ~PackageIndex();
+
+  PackageIndex(const PackageIndex&) = delete;
+  PackageIndex& operator=(const PackageIndex&) = delete;
+
+  PackageIndex(PackageIndex&& other);
+  PackageIndex& operator=(PackageIndex&& other);
+
+  int size() const { return header().package_count; }
+
+  PackageView Get(int i) const { return PackageView(this, &records()[i]); }
+
+  std::optional<PackageView> FindByName(std::string_view name) const;
+
+  // Returns the packages which declare |relation| to |name|, in index order,
+  // e.g. all packages which depend on "pacman".
+  std::vector<PackageView> FindByRelation(PackageRelation relation,
+                                          std::string_view name) const;
+
+ private:
+  friend class PackageView;
+  friend class StringListView;
+
+  PackageIndex(const void* data, size_t size) : data_(data), size_(size) {}
+
+  const package_index_format::Header& header() const {
+    return *static_cast<const package_index_format::Header*>(data_);
+  }
+
+  template <typename T>
+  const T* Section(uint64_t offset) const {
+    return reinterpret_cast<const T*>(static_cast<const char*>(data_) + offset);
+  }
+
+  const package_index_format::Record* records() const {
+    return Section<package_index_format::Record>(header().records_offset);
+  }
+
+  std::string_view String(package_index_format::StringRef ref) const {
+    return std::string_view(
+        Section<char>(header().string_table_offset) + ref.offset, ref.size);
+  }
+
+  const void* data_;
+  size_t size_;
+};
+
+inline std::string_view StringListView::Iterator::operator*() const {
+  return index_->String(*ref_);
+}
+
+inline std::string_view PackageView::String(
+    package_index_format::StringRef ref) const {
+  return index_->String(ref);
+}
+
+inline StringListView PackageView::List(
+    package_index_format::ListRef ref) const {
+  return StringListView(
+      index_,
+      index_->Section<package_index_format::StringRef>(
+          index_->header().list_entries_offset) +
+          ref.begin,
+      ref.size);
+}
+
+}  // namespace aur
+
+#endif  // AUR_PACKAGE_INDEX_HH_
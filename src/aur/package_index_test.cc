@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: MIT
+#include "aur/package_index.hh"
+
+#include <filesystem>
+#include <fstream>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace fs = std::filesystem;
+
+using aur::Package;
+using aur::PackageIndex;
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+class PackageIndexTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = fs::path(testing::TempDir()) /
+            testing::UnitTest::GetInstance()->current_test_info()->name();
+    fs::remove(path_);
+  }
+
+  void TearDown() override { fs::remove(path_); }
+
+  std::string path_;
+};
+
+Package MakePackage(std::string name, std::string pkgbase = "") {
+  Package p;
+  p.name = name;
+  p.pkgbase = pkgbase.empty() ? name : pkgbase;
+  return p;
+}
+
+TEST_F(PackageIndexTest, RoundTripsPackages) {
+  Package p = MakePackage("auracle-git");
+  p.description = "A flexible client for the AUR";
+  p.submitter = "falconindy";
+  p.maintainer = "falconindy";
+  p.upstream_url = "https://github.com/falconindy/auracle.git";
+  p.aur_urlpath = "/cgit/aur.git/snapshot/auracle-git.tar.gz";
+  p.version = "r74.82e863f-1";
+  p.package_id = 534056;
+  p.pkgbase_id = 123768;
+  p.votes = 15;
+  p.popularity = 0.095498;
+  p.submitted = absl::FromUnixSeconds(1499013608);
+  p.modified = absl::FromUnixSeconds(1534800258);
+  p.out_of_date = absl::FromUnixSeconds(1534800259);
+  p.depends = {"pacman", "libarchive.so", "libcurl.so", "libsystemd.so"};
+  p.makedepends = {"meson", "git", "nlohmann-json"};
+  p.checkdepends = {"python"};
+  p.provides = {"auracle"};
+  p.conflicts = {"auracle"};
+  p.replaces = {"cower-git"};
+  p.licenses = {"MIT"};
+  p.keywords = {"aur"};
+  p.groups = {"helpers"};
+  p.comaintainers = {"someone"};
+  p.optdepends = {"awk: for pkgbuild-vers"};
+
+  ASSERT_TRUE(PackageIndex::Write(path_, {p}).ok());
+
+  auto index = PackageIndex::Open(path_);
+  ASSERT_TRUE(index.ok()) << index.status();
+  ASSERT_EQ(index->size(), 1);
+
+  const auto view = index->Get(0);
+  EXPECT_EQ(view.name(), "auracle-git");
+  EXPECT_EQ(view.description(), p.description);
+  EXPECT_EQ(view.version(), p.version);
+  EXPECT_EQ(view.popularity(), p.popularity);
+  EXPECT_EQ(view.submitted(), p.submitted);
+  EXPECT_THAT(view.depends(), ElementsAre("pacman", "libarchive.so",
+                                          "libcurl.so", "libsystemd.so"));
+  EXPECT_THAT(view.groups(), ElementsAre("helpers"));
+
+  const Package copy = view.ToPackage();
+  EXPECT_EQ(copy, p);
+  EXPECT_EQ(copy.name, p.name);
+  EXPECT_EQ(copy.modified, p.modified);
+  EXPECT_EQ(copy.out_of_date, p.out_of_date);
+  EXPECT_EQ(copy.makedepends, p.makedepends);
+  EXPECT_EQ(copy.checkdepends, p.checkdepends);
+  EXPECT_EQ(copy.optdepends, p.optdepends);
+  EXPECT_EQ(copy.comaintainers, p.comaintainers);
+}
+
+TEST_F(PackageIndexTest, FindsPackagesByName) {
+  ASSERT_TRUE(PackageIndex::Write(path_, {
+                                             MakePackage("pkgfile-git"),
+                                             MakePackage("auracle-git"),
+                                             MakePackage("python-foo", "foo"),
+                                             MakePackage("foo"),
+                                         })
+                  .ok());
+
+  auto index = PackageIndex::Open(path_);
+  ASSERT_TRUE(index.ok()) << index.status();
+
+  for (const auto name : {"auracle-git", "foo", "pkgfile-git", "python-foo"}) {
+    const auto view = index->FindByName(name);
+    ASSERT_TRUE(view.has_value()) << name;
+    EXPECT_EQ(view->name(), name);
+  }
+  EXPECT_EQ(index->FindByName("python-foo")->pkgbase(), "foo");
+
+  EXPECT_EQ(index->FindByName("aaa"), std::nullopt);
+  EXPECT_EQ(index->FindByName("auracle"), std::nullopt);
+  EXPECT_EQ(index->FindByName("zzz"), std::nullopt);
+}
+
+std::vector<std::string_view> Names(
+    const std::vector<aur::PackageView>& packages) {
+  std::vector<std::string_view> names;
+  for (const auto& p : packages) {
+    names.push_back(p.name());
+  }
+  return names;
+}
+
+TEST_F(PackageIndexTest, FindsPackagesByRelation) {
+  using aur::PackageRelation;
+
+  Package auracle = MakePackage("auracle-git");
+  auracle.depends = {"pacman>=6", "libcurl.so"};
+  auracle.makedepends = {"meson", "git"};
+  auracle.provides = {"auracle=1"};
+
+  Package pkgfile = MakePackage("pkgfile-git");
+  pkgfile.depends = {"pacman", "pacman-contrib"};
+  pkgfile.checkdepends = {"python"};
+  pkgfile.optdepends = {"git: for fetching sources", "git"};
+  pkgfile.provides = {"pkgfile"};
+
+  ASSERT_TRUE(PackageIndex::Write(path_, {auracle, pkgfile}).ok());
+
+  auto index = PackageIndex::Open(path_);
+  ASSERT_TRUE(index.ok()) << index.status();
+
+  EXPECT_THAT(Names(index->FindByRelation(PackageRelation::DEPENDS, "pacman")),
+              ElementsAre("auracle-git", "pkgfile-git"));
+  EXPECT_THAT(Names(index->FindByRelation(PackageRelation::DEPENDS, "pac")),
+              IsEmpty());
+  EXPECT_THAT(Names(index->FindByRelation(PackageRelation::MAKEDEPENDS, "git")),
+              ElementsAre("auracle-git"));
+  EXPECT_THAT(Names(index->FindByRelation(PackageRelation::OPTDEPENDS, "git")),
+              ElementsAre("pkgfile-git"));
+  EXPECT_THAT(
+      Names(index->FindByRelation(PackageRelation::CHECKDEPENDS, "python")),
+      ElementsAre("pkgfile-git"));
+  EXPECT_THAT(
+      Names(index->FindByRelation(PackageRelation::PROVIDES, "auracle")),
+      ElementsAre("auracle-git"));
+  EXPECT_THAT(
+      Names(index->FindByRelation(PackageRelation::PROVIDES, "auracle-git")),
+      ElementsAre("auracle-git"));
+}
+
+TEST_F(PackageIndexTest, HandlesEmptyIndexes) {
+  ASSERT_TRUE(PackageIndex::Write(path_, {}).ok());
+
+  auto index = PackageIndex::Open(path_);
+  ASSERT_TRUE(index.ok()) << index.status();
+  EXPECT_EQ(index->size(), 0);
+  EXPECT_EQ(index->FindByName("auracle-git"), std::nullopt);
+}
+
+TEST_F(PackageIndexTest, EmptyListsAreEmpty) {
+  ASSERT_TRUE(PackageIndex::Write(path_, {MakePackage("auracle-git")}).ok());
+
+  auto index = PackageIndex::Open(path_);
+  ASSERT_TRUE(index.ok()) << index.status();
+  EXPECT_THAT(index->Get(0).depends(), IsEmpty());
+  EXPECT_THAT(index->Get(0).depends().ToVector(), IsEmpty());
+}
+
+TEST_F(PackageIndexTest, RejectsMissingFiles) {
+  EXPECT_TRUE(absl::IsNotFound(PackageIndex::Open(path_).status()));
+}
+
+TEST_F(PackageIndexTest, RejectsForeignFiles) {
+  std::ofstream(path_) << "[{\"Name\": \"auracle-git\"}]";
+
+  EXPECT_TRUE(absl::IsDataLoss(PackageIndex::Open(path_).status()));
+}
+
+TEST_F(PackageIndexTest, RejectsTruncatedFiles) {
+  ASSERT_TRUE(PackageIndex::Write(path_, {MakePackage("auracle-git")}).ok());
+  fs::resize_file(path_, fs::file_size(path_) - 4);
+
+  EXPECT_TRUE(absl::IsDataLoss(PackageIndex::Open(path_).status()));
+}
+
+TEST_F(PackageIndexTest, RejectsOtherVersions) {
+  ASSERT_TRUE(PackageIndex::Write(path_, {MakePackage("auracle-git")}).ok());
+  {
+    std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offsetof(aur::package_index_format::Header, version));
+    const uint32_t version = aur::package_index_format::kVersion + 1;
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+
+  EXPECT_TRUE(absl::IsFailedPrecondition(PackageIndex::Open(path_).status()));
+}
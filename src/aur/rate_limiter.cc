@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MIT
+#include "aur/rate_limiter.hh"
+
+#include <algorithm>
+
+namespace aur {
+
+namespace {
+
+constexpr absl::Duration kBaseRetryDelay = absl::Seconds(1);
+constexpr absl::Duration kMaxRetryDelay = absl::Seconds(64);
+
+}  // namespace
+
+absl::Time RateLimiter::Acquire(absl::Time now) {
+  if (rate_ <= 0) {
+    return now;
+  }
+
+  if (now > last_refill_) {
+    if (last_refill_ != absl::InfinitePast()) {
+      tokens_ = std::min(
+          burst_, tokens_ + absl::ToDoubleSeconds(now - last_refill_) * rate_);
+    }
+    last_refill_ = now;
+  }
+
+  tokens_ -= 1;
+  if (tokens_ >= 0) {
+    return now;
+  }
+
+  // Wait for the deficit to be refilled.
+  return last_refill_ + absl::Seconds(-tokens_ / rate_);
+}
+
+absl::Duration RetryDelay(int attempt,
+                          std::optional<absl::Duration> retry_after,
+                          double jitter) {
+  if (retry_after.has_value()) {
+    return std::clamp(*retry_after, absl::ZeroDuration(), kMaxRetryDelay);
+  }
+
+  const absl::Duration delay =
+      std::min(kBaseRetryDelay * (int64_t{1} << std::min(attempt, 6)),
+               kMaxRetryDelay);
+  return delay / 2 + delay / 2 * jitter;
+}
+
+}  // namespace aur
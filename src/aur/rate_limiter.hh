@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_RATE_LIMITER_HH_
+#define AUR_RATE_LIMITER_HH_
+
+#include <optional>
+
+#include "absl/time/time.h"
+
+namespace aur {
+
+// RateLimiter is a token bucket. It allows bursts of up to |burst| requests,
+// refilling at |rate| requests per second. A rate of zero means no limit.
+class RateLimiter {
+ public:
+  RateLimiter(double rate, double burst)
+      : rate_(rate), burst_(burst), tokens_(burst) {}
+
+  RateLimiter(const RateLimiter&) = default;
+  RateLimiter& operator=(const RateLimiter&) = default;
+
+  RateLimiter(RateLimiter&&) = default;
+  RateLimiter& operator=(RateLimiter&&) = default;
+
+  // Takes a token on behalf of a request which is ready at |now|, and returns
+  // the time at which it may be sent. Tokens are reserved ahead of time, so
+  // the requests of a burst are spread out rather than waiting together.
+  absl::Time Acquire(absl::Time now);
+
+ private:
+  double rate_;
+  double burst_;
+
+  // May be negative, when tokens have been reserved ahead of time.
+  double tokens_;
+  absl::Time last_refill_ = absl::InfinitePast();
+};
+
+// Returns how long to wait before retrying a throttled request for the
+// |attempt|th time, counting from zero. The server's |retry_after| is used as
+// given, up to the longest delay that would otherwise be used, so that a server
+// can't stall us indefinitely. Otherwise the delay doubles with each attempt,
+// and half of it is scaled by |jitter|, in [0, 1), so that clients throttled
+// together don't all retry together.
+absl::Duration RetryDelay(int attempt,
+                          std::optional<absl::Duration> retry_after,
+                          double jitter);
+
+}  // namespace aur
+
+#endif  // AUR_RATE_LIMITER_HH_
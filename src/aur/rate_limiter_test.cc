@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: MIT
+#include "aur/rate_limiter.hh"
+
+#include "gtest/gtest.h"
+
+using aur::RateLimiter;
+using aur::RetryDelay;
+
+namespace {
+
+const absl::Time kEpoch = absl::FromUnixSeconds(1700000000);
+
+}  // namespace
+
+TEST(RateLimiterTest, AllowsBursts) {
+  RateLimiter limiter(/*rate=*/2, /*burst=*/3);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(limiter.Acquire(kEpoch), kEpoch);
+  }
+}
+
+TEST(RateLimiterTest, SpreadsRequestsBeyondTheBurst) {
+  RateLimiter limiter(/*rate=*/2, /*burst=*/1);
+
+  EXPECT_EQ(limiter.Acquire(kEpoch), kEpoch);
+  EXPECT_EQ(limiter.Acquire(kEpoch), kEpoch + absl::Milliseconds(500));
+  EXPECT_EQ(limiter.Acquire(kEpoch), kEpoch + absl::Seconds(1));
+
+  // Those reservations have to be paid off before more tokens accrue.
+  EXPECT_EQ(limiter.Acquire(kEpoch + absl::Seconds(1)),
+            kEpoch + absl::Milliseconds(1500));
+}
+
+TEST(RateLimiterTest, RefillsUpToTheBurst) {
+  RateLimiter limiter(/*rate=*/1, /*burst=*/2);
+
+  EXPECT_EQ(limiter.Acquire(kEpoch), kEpoch);
+  EXPECT_EQ(limiter.Acquire(kEpoch), kEpoch);
+
+  const absl::Time later = kEpoch + absl::Hours(1);
+  EXPECT_EQ(limiter.Acquire(later), later);
+  EXPECT_EQ(limiter.Acquire(later), later);
+  EXPECT_EQ(limiter.Acquire(later), later + absl::Seconds(1));
+}
+
+TEST(RateLimiterTest, UnlimitedWithoutARate) {
+  RateLimiter limiter(/*rate=*/0, /*burst=*/0);
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(limiter.Acquire(kEpoch), kEpoch);
+  }
+}
+
+TEST(RetryDelayTest, HonorsRetryAfter) {
+  EXPECT_EQ(RetryDelay(0, absl::Seconds(30), 0.5), absl::Seconds(30));
+  EXPECT_EQ(RetryDelay(5, absl::ZeroDuration(), 0.5), absl::ZeroDuration());
+  EXPECT_EQ(RetryDelay(0, absl::Hours(24), 0.5), absl::Seconds(64));
+}
+
+TEST(RetryDelayTest, BacksOffExponentially) {
+  EXPECT_EQ(RetryDelay(0, std::nullopt, 0), absl::Milliseconds(500));
+  EXPECT_EQ(RetryDelay(1, std::nullopt, 0), absl::Seconds(1));
+  EXPECT_EQ(RetryDelay(2, std::nullopt, 0), absl::Seconds(2));
+  EXPECT_EQ(RetryDelay(2, std::nullopt, 0.5), absl::Seconds(3));
+  EXPECT_EQ(RetryDelay(100, std::nullopt, 0), absl::Seconds(32));
+}
@@ -40,6 +40,25 @@ std::string RpcRequest::Payload() const {
   return absl::StrJoin(params_, "&", QueryParamFormatter);
 }
 
+std::vector<RpcRequest> RpcRequest::Shard(int max_args) const {
+  if (max_args <= 0 || params_.size() <= static_cast<size_t>(max_args)) {
+    return {*this};
+  }
+
+  std::vector<RpcRequest> shards;
+  shards.reserve((params_.size() + max_args - 1) / max_args);
+
+  for (size_t i = 0; i < params_.size(); ++i) {
+    if (i % max_args == 0) {
+      shards.emplace_back(command_, endpoint_).fields_ = fields_;
+    }
+
+    shards.back().params_.push_back(params_[i]);
+  }
+
+  return shards;
+}
+
 SearchRequest::SearchRequest(SearchBy by, std::string_view arg)
     : RpcRequest(HttpRequest::Command::GET,
                  absl::StrFormat("/rpc/v5/search/%s?by=%s", UrlEscape(arg),
@@ -52,6 +71,11 @@ RawRequest RawRequest::ForSourceFile(const Package& package,
                                  "?h=", UrlEscape(package.pkgbase)));
 }
 
+RawRequest RawRequest::ForSnapshot(const Package& package) {
+  return RawRequest(absl::StrCat("/cgit/aur.git/snapshot/",
+                                 UrlEscape(package.pkgbase), ".tar.gz"));
+}
+
 std::string RawRequest::Url(std::string_view baseurl) const {
   return absl::StrCat(baseurl, urlpath_);
 }
@@ -8,6 +8,7 @@
 
 #include "absl/strings/str_format.h"
 #include "aur/package.hh"
+#include "aur/package_fields.hh"
 
 namespace aur {
 
@@ -49,9 +50,20 @@ class RpcRequest : public HttpRequest {
 
   void AddArg(std::string key, std::string value);
 
+  // Splits the request into multiple requests for the same endpoint, each
+  // carrying at most |max_args| parameters. A request which doesn't exceed the
+  // limit, or a |max_args| of zero, yields a single request.
+  std::vector<RpcRequest> Shard(int max_args) const;
+
+  // Limits the fields decoded from each package in the response. The AUR
+  // always sends every field, so the rest are skipped over while parsing.
+  void set_fields(PackageFields fields) { fields_ = std::move(fields); }
+  const PackageFields& fields() const { return fields_; }
+
  private:
   std::string endpoint_;
   QueryParams params_;
+  PackageFields fields_ = PackageFields::All();
 };
 
 // A class describing a GET request for an arbitrary URL on the AUR.
@@ -60,6 +72,9 @@ class RawRequest : public HttpRequest {
   static RawRequest ForSourceFile(const Package& package,
                                   std::string_view filename);
 
+  // A gzipped tarball of the sources of |package|'s current revision.
+  static RawRequest ForSnapshot(const Package& package);
+
   explicit RawRequest(std::string urlpath)
       : HttpRequest(HttpRequest::Command::GET), urlpath_(std::move(urlpath)) {}
 
@@ -82,18 +97,30 @@ class CloneRequest : public Request {
   explicit CloneRequest(std::string reponame)
       : reponame_(std::move(reponame)) {}
 
-  CloneRequest(const CloneRequest&) = delete;
-  CloneRequest& operator=(const CloneRequest&) = delete;
+  CloneRequest(const CloneRequest&) = default;
+  CloneRequest& operator=(const CloneRequest&) = default;
 
   CloneRequest(CloneRequest&&) = default;
   CloneRequest& operator=(CloneRequest&&) = default;
 
   const std::string& reponame() const { return reponame_; }
 
+  // Limits clones and updates to the given number of commits of history. Zero
+  // fetches the full history.
+  void set_depth(int depth) { depth_ = depth; }
+  int depth() const { return depth_; }
+
+  // A git object filter, e.g. "blob:none", with which to make a partial clone.
+  // Updates of a partial clone reuse the filter that it was cloned with.
+  void set_filter(std::string filter) { filter_ = std::move(filter); }
+  const std::string& filter() const { return filter_; }
+
   std::string Url(std::string_view baseurl) const override;
 
  private:
   std::string reponame_;
+  int depth_ = 0;
+  std::string filter_;
 };
 
 class InfoRequest : public RpcRequest {
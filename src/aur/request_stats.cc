@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: MIT
+#include "aur/request_stats.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+
+namespace aur {
+
+namespace {
+
+struct Phase {
+  std::string_view name;
+  absl::Duration RequestTiming::* duration;
+};
+
+constexpr Phase kPhases[] = {
+    {"dns", &RequestTiming::dns},
+    {"connect", &RequestTiming::connect},
+    {"tls", &RequestTiming::tls},
+    {"ttfb", &RequestTiming::ttfb},
+    {"transfer", &RequestTiming::transfer},
+    {"parse", &RequestTiming::parse},
+    {"callback", &RequestTiming::callback},
+};
+
+struct Distribution {
+  absl::Duration p50;
+  absl::Duration p95;
+  absl::Duration max;
+};
+
+// Uses the nearest-rank method, so that every reported value was observed.
+Distribution Distribute(const std::vector<RequestTiming>& requests,
+                        absl::Duration RequestTiming::* duration) {
+  std::vector<absl::Duration> values;
+  values.reserve(requests.size());
+  for (const auto& request : requests) {
+    values.push_back(request.*duration);
+  }
+  absl::c_sort(values);
+
+  const auto percentile = [&](double p) {
+    const size_t rank = std::ceil(p * values.size());
+    return values[std::max<size_t>(rank, 1) - 1];
+  };
+
+  return {percentile(0.50), percentile(0.95), values.back()};
+}
+
+struct Totals {
+  int cached = 0;
+  int reused_connections = 0;
+  int connections_opened = 0;
+  int peak_in_flight = 0;
+  int64_t bytes_in = 0;
+  int64_t bytes_out = 0;
+};
+
+// Returns the largest number of transfers which were in flight at once.
+int PeakInFlight(const std::vector<RequestTiming>& requests) {
+  // Ends sort before starts at the same time, as +1 sorts after -1.
+  std::vector<std::pair<absl::Time, int>> events;
+  for (const auto& request : requests) {
+    if (!request.cached) {
+      events.emplace_back(request.start, 1);
+      events.emplace_back(request.finish, -1);
+    }
+  }
+  absl::c_sort(events);
+
+  int in_flight = 0, peak = 0;
+  for (const auto& [time, delta] : events) {
+    in_flight += delta;
+    peak = std::max(peak, in_flight);
+  }
+  return peak;
+}
+
+Totals Sum(const std::vector<RequestTiming>& requests) {
+  Totals totals;
+  for (const auto& request : requests) {
+    totals.cached += request.cached;
+    totals.reused_connections += request.reused_connection;
+    totals.connections_opened +=
+        !request.cached && !request.reused_connection;
+    totals.bytes_in += request.bytes_in;
+    totals.bytes_out += request.bytes_out;
+  }
+  totals.peak_in_flight = PeakInFlight(requests);
+  return totals;
+}
+
+std::string HumanDuration(absl::Duration d) {
+  return absl::FormatDuration(absl::Trunc(d, absl::Microseconds(1)));
+}
+
+std::string JsonString(std::string_view s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      absl::StrAppend(&out, "\\", std::string_view(&c, 1));
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&out, "\\u%04x", c);
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+  return out;
+}
+
+}  // namespace
+
+std::string RequestStats::Summary() const {
+  if (requests_.empty()) {
+    return "requests: 0\n";
+  }
+
+  const Totals totals = Sum(requests_);
+
+  std::string out = absl::StrFormat(
+      "requests: %d (%d cached, %d on reused connections)\n"
+      "bytes: %d in, %d out\n"
+      "concurrency: %d connections opened, %d requests in flight at peak\n"
+      "%-10s %12s %12s %12s\n",
+      requests_.size(), totals.cached, totals.reused_connections,
+      totals.bytes_in, totals.bytes_out, totals.connections_opened,
+      totals.peak_in_flight, "phase", "p50", "p95", "max");
+
+  for (const auto& phase : kPhases) {
+    const auto d = Distribute(requests_, phase.duration);
+    absl::StrAppendFormat(&out, "%-10s %12s %12s %12s\n", phase.name,
+                          HumanDuration(d.p50), HumanDuration(d.p95),
+                          HumanDuration(d.max));
+  }
+
+  return out;
+}
+
+std::string RequestStats::ToJson() const {
+  const Totals totals = Sum(requests_);
+
+  std::string out = absl::StrFormat(
+      R"({"requests":%d,"cached":%d,"reused_connections":%d,)"
+      R"("connections_opened":%d,"peak_in_flight":%d,)"
+      R"("bytes_in":%d,"bytes_out":%d,"phases":{)",
+      requests_.size(), totals.cached, totals.reused_connections,
+      totals.connections_opened, totals.peak_in_flight, totals.bytes_in,
+      totals.bytes_out);
+
+  if (!requests_.empty()) {
+    std::vector<std::string> phases;
+    for (const auto& phase : kPhases) {
+      const auto d = Distribute(requests_, phase.duration);
+      phases.push_back(absl::StrFormat(
+          R"("%s":{"p50_us":%d,"p95_us":%d,"max_us":%d})", phase.name,
+          absl::ToInt64Microseconds(d.p50), absl::ToInt64Microseconds(d.p95),
+          absl::ToInt64Microseconds(d.max)));
+    }
+    absl::StrAppend(&out, absl::StrJoin(phases, ","));
+  }
+
+  absl::StrAppend(&out, R"(},"request_timings":[)");
+
+  std::vector<std::string> timings;
+  for (const auto& request : requests_) {
+    std::string timing = absl::StrCat(R"({"url":)", JsonString(request.url));
+    for (const auto& phase : kPhases) {
+      absl::StrAppendFormat(&timing, R"(,"%s_us":%d)", phase.name,
+                            absl::ToInt64Microseconds(request.*phase.duration));
+    }
+    absl::StrAppendFormat(
+        &timing, R"(,"bytes_in":%d,"bytes_out":%d,"reused_connection":%s,)"
+                 R"("cached":%s})",
+        request.bytes_in, request.bytes_out,
+        request.reused_connection ? "true" : "false",
+        request.cached ? "true" : "false");
+    timings.push_back(std::move(timing));
+  }
+  absl::StrAppend(&out, absl::StrJoin(timings, ","), "]}");
+
+  return out;
+}
+
+}  // namespace aur
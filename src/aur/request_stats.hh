@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_REQUEST_STATS_HH_
+#define AUR_REQUEST_STATS_HH_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace aur {
+
+// Where the time went for a single HTTP request. Network phases are as reported
+// by curl, and are zero for responses served from the cache.
+struct RequestTiming {
+  std::string url;
+
+  // Resolving the host, establishing the connection and negotiating TLS.
+  absl::Duration dns;
+  absl::Duration connect;
+  absl::Duration tls;
+
+  // From the start of the request until the first byte of the response, and
+  // from then until the last byte.
+  absl::Duration ttfb;
+  absl::Duration transfer;
+
+  // Time spent decoding the response, and in the caller's callback.
+  absl::Duration parse;
+  absl::Duration callback;
+
+  // When the transfer started and finished, for working out how many were in
+  // flight at once. Unset for responses served from the cache.
+  absl::Time start;
+  absl::Time finish;
+
+  int64_t bytes_in = 0;
+  int64_t bytes_out = 0;
+
+  bool reused_connection = false;
+  bool cached = false;
+};
+
+// RequestStats collects the timings of the requests made by a Client, and
+// summarizes them.
+class RequestStats {
+ public:
+  RequestStats() = default;
+
+  RequestStats(const RequestStats&) = delete;
+  RequestStats& operator=(const RequestStats&) = delete;
+
+  RequestStats(RequestStats&&) = default;
+  RequestStats& operator=(RequestStats&&) = default;
+
+  void Record(RequestTiming timing) { requests_.push_back(std::move(timing)); }
+
+  const std::vector<RequestTiming>& requests() const { return requests_; }
+
+  // A human readable summary: request counts, bytes transferred, connection
+  // reuse and concurrency, and the p50/p95/max of each phase.
+  std::string Summary() const;
+
+  // The same summary as a JSON object, along with the timings of each request.
+  // Durations are given in microseconds.
+  std::string ToJson() const;
+
+ private:
+  std::vector<RequestTiming> requests_;
+};
+
+}  // namespace aur
+
+#endif  // AUR_REQUEST_STATS_HH_
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+#include "aur/request_stats.hh"
+
+#include <tuple>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using aur::RequestStats;
+using aur::RequestTiming;
+using testing::HasSubstr;
+
+namespace {
+
+RequestTiming MakeTiming(int ttfb_ms, bool reused, bool cached = false) {
+  RequestTiming timing;
+  timing.url = "https://aur.archlinux.org/rpc/v5/info";
+  timing.ttfb = absl::Milliseconds(ttfb_ms);
+  timing.bytes_in = 1000;
+  timing.bytes_out = 100;
+  timing.reused_connection = reused;
+  timing.cached = cached;
+  return timing;
+}
+
+}  // namespace
+
+TEST(RequestStatsTest, SummarizesNothing) {
+  RequestStats stats;
+
+  EXPECT_EQ(stats.Summary(), "requests: 0\n");
+  EXPECT_THAT(stats.ToJson(), HasSubstr(R"("requests":0)"));
+}
+
+TEST(RequestStatsTest, SummarizesRequests) {
+  RequestStats stats;
+  for (int i = 1; i <= 20; ++i) {
+    stats.Record(MakeTiming(i, /*reused=*/i > 1, /*cached=*/i == 20));
+  }
+
+  const auto summary = stats.Summary();
+  EXPECT_THAT(summary,
+              HasSubstr("requests: 20 (1 cached, 19 on reused connections)"));
+  EXPECT_THAT(summary, HasSubstr("bytes: 20000 in, 2000 out"));
+  EXPECT_THAT(summary, testing::ContainsRegex("ttfb +10ms +19ms +20ms"));
+}
+
+TEST(RequestStatsTest, SummarizesConcurrency) {
+  const absl::Time epoch = absl::FromUnixSeconds(1700000000);
+
+  RequestStats stats;
+  for (const auto& [start, finish, reused] :
+       {std::tuple{0, 10, false}, {5, 15, true}, {10, 20, false}}) {
+    auto timing = MakeTiming(1, reused);
+    timing.start = epoch + absl::Milliseconds(start);
+    timing.finish = epoch + absl::Milliseconds(finish);
+    stats.Record(std::move(timing));
+  }
+  stats.Record(MakeTiming(1, /*reused=*/false, /*cached=*/true));
+
+  EXPECT_THAT(stats.Summary(),
+              HasSubstr("concurrency: 2 connections opened, 2 requests in "
+                        "flight at peak"));
+  EXPECT_THAT(stats.ToJson(),
+              HasSubstr(R"("connections_opened":2,"peak_in_flight":2)"));
+}
+
+TEST(RequestStatsTest, SerializesToJson) {
+  RequestStats stats;
+  stats.Record(MakeTiming(5, /*reused=*/false));
+  stats.Record(MakeTiming(7, /*reused=*/true));
+
+  const auto json = stats.ToJson();
+  EXPECT_THAT(json, HasSubstr(R"("requests":2,"cached":0)"));
+  EXPECT_THAT(json, HasSubstr(R"("reused_connections":1)"));
+  EXPECT_THAT(json, HasSubstr(R"("ttfb":{"p50_us":5000,"p95_us":7000,)"
+                              R"("max_us":7000})"));
+  EXPECT_THAT(json, HasSubstr(R"({"url":"https://aur.archlinux.org/rpc/v5/)"
+                              R"(info","dns_us":0)"));
+}
@@ -24,6 +24,39 @@ TEST(RequestTest, BuildsInfoRequests) {
   EXPECT_EQ(payload, "arg[]=derp");
 }
 
+TEST(RequestTest, ShardsInfoRequests) {
+  aur::InfoRequest request;
+  for (const auto& arg : {"a", "b", "c", "d", "e"}) {
+    request.AddArg(arg);
+  }
+  request.set_fields({aur::PackageField::NAME});
+
+  const auto shards = request.Shard(2);
+  ASSERT_EQ(shards.size(), 3);
+
+  EXPECT_EQ(shards[0].Payload(), "arg[]=a&arg[]=b");
+  EXPECT_EQ(shards[1].Payload(), "arg[]=c&arg[]=d");
+  EXPECT_EQ(shards[2].Payload(), "arg[]=e");
+
+  for (const auto& shard : shards) {
+    EXPECT_EQ(shard.Url(kBaseUrl), request.Url(kBaseUrl));
+    EXPECT_EQ(shard.command(), request.command());
+    EXPECT_EQ(shard.fields(), request.fields());
+  }
+}
+
+TEST(RequestTest, DoesNotShardSmallRequests) {
+  aur::InfoRequest request;
+  request.AddArg("a");
+  request.AddArg("b");
+
+  for (int max_args : {0, 2, 5}) {
+    const auto shards = request.Shard(max_args);
+    ASSERT_EQ(shards.size(), 1);
+    EXPECT_EQ(shards[0].Payload(), request.Payload());
+  }
+}
+
 TEST(RequestTest, UrlEncodesParameterValues) {
   aur::InfoRequest irequest;
 
@@ -64,6 +97,17 @@ TEST(RequestTest, UrlForSourceFileEscapesReponame) {
   EXPECT_THAT(url, EndsWith("/PKGBUILD?h=libc%2B%2B"));
 }
 
+TEST(RequestTest, UrlForSnapshotEscapesPkgbase) {
+  aur::Package p;
+  p.pkgbase = "libc++";
+  auto request = aur::RawRequest::ForSnapshot(p);
+
+  auto url = request.Url(kBaseUrl);
+
+  EXPECT_EQ(url,
+            std::string(kBaseUrl) + "/cgit/aur.git/snapshot/libc%2B%2B.tar.gz");
+}
+
 TEST(RequestTest, BuildsCloneRequests) {
   const std::string kReponame = "auracle-git";
 
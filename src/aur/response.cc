@@ -1,6 +1,14 @@
 // SPDX-License-Identifier: MIT
 #include "aur/response.hh"
 
+#include <zlib.h>
+
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
 #include "glaze/glaze.hpp"
 
 template <>
@@ -46,6 +54,54 @@ struct glz::meta<aur::Package> {
 
 namespace aur {
 
+namespace {
+
+constexpr glz::opts kParseOpts{
+    .error_on_unknown_keys = false,
+    .error_on_missing_keys = false,
+};
+
+bool IsGzipped(std::string_view bytes) {
+  return bytes.size() >= 2 && bytes[0] == '\x1f' && bytes[1] == '\x8b';
+}
+
+absl::StatusOr<std::string> Gunzip(std::string_view bytes) {
+  z_stream stream{};
+  // 16 + MAX_WBITS tells zlib to expect a gzip header.
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+    return absl::InternalError("failed to initialize zlib");
+  }
+
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(bytes.data()));
+  stream.avail_in = bytes.size();
+
+  std::string out;
+  int r;
+  do {
+    const size_t offset = out.size();
+    out.resize(offset + std::max<size_t>(bytes.size() * 4, 1 << 16));
+
+    stream.next_out = reinterpret_cast<Bytef*>(out.data() + offset);
+    stream.avail_out = out.size() - offset;
+
+    r = inflate(&stream, Z_NO_FLUSH);
+    out.resize(out.size() - stream.avail_out);
+  } while (r == Z_OK);
+
+  const std::string_view error =
+      stream.msg != nullptr ? stream.msg : "truncated input";
+  inflateEnd(&stream);
+
+  if (r != Z_STREAM_END) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("decompression error: ", error));
+  }
+
+  return out;
+}
+
+}  // namespace
+
 struct Raw {
   std::vector<Package> packages;
   std::string error;
@@ -58,22 +114,171 @@ struct Raw {
   };
 };
 
-absl::StatusOr<RpcResponse> RpcResponse::Parse(std::string_view bytes) {
-  static constexpr glz::opts opts{
-      .error_on_unknown_keys = false,
-      .error_on_missing_keys = false,
-  };
+// static
+absl::StatusOr<RpcResponse> RpcResponse::Parse(std::string_view bytes,
+                                               PackageFields fields) {
+  RpcResponseParser parser(std::move(fields));
+  parser.Feed(bytes).IgnoreError();
+  return std::move(parser).Finish();
+}
+
+absl::Status RpcResponseParser::Feed(std::string_view bytes) {
+  if (!status_.ok()) {
+    return status_;
+  }
+
+  // Bytes are copied to the skeleton or the current package in runs, starting
+  // at |begin|. Separators between packages are dropped.
+  size_t begin = 0;
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    const char c = bytes[i];
+
+    if (in_string_) {
+      if (escaped_) {
+        escaped_ = false;
+      } else if (c == '\\') {
+        escaped_ = true;
+      } else if (c == '"') {
+        in_string_ = false;
+      }
+      continue;
+    }
+
+    if (state_ == State::RESULTS) {
+      if (c == '{') {
+        state_ = State::PACKAGE;
+        begin = i;
+        ++depth_;
+      } else if (c == ']') {
+        state_ = State::TOP_LEVEL;
+        begin = i;
+        --depth_;
+      } else if (c != ',' && !absl::ascii_isspace(c)) {
+        return status_ = absl::InvalidArgumentError(
+                   absl::StrCat("parse error: unexpected '",
+                                std::string_view(&c, 1), "' in results"));
+      }
+      continue;
+    }
+
+    switch (c) {
+      case '"':
+        in_string_ = true;
+        break;
+      case '[':
+        if (state_ == State::TOP_LEVEL && depth_ == 1) {
+          skeleton_.append(bytes.substr(begin, i - begin));
+          begin = i;
+
+          std::string_view key = absl::StripTrailingAsciiWhitespace(skeleton_);
+          if (absl::ConsumeSuffix(&key, ":") &&
+              absl::EndsWith(absl::StripTrailingAsciiWhitespace(key),
+                             "\"results\"")) {
+            skeleton_.push_back(c);
+            begin = i + 1;
+            state_ = State::RESULTS;
+          }
+        }
+        ++depth_;
+        break;
+      case '{':
+        ++depth_;
+        break;
+      case ']':
+      case '}':
+        --depth_;
+        if (state_ == State::PACKAGE && depth_ == 2) {
+          AppendPackage(bytes.substr(begin, i + 1 - begin));
+          begin = i + 1;
+          state_ = State::RESULTS;
+
+          if (auto status = ParsePackage(); !status.ok()) {
+            return status_ = std::move(status);
+          }
+        }
+        break;
+    }
+  }
+
+  switch (state_) {
+    case State::TOP_LEVEL:
+      skeleton_.append(bytes.substr(begin));
+      break;
+    case State::PACKAGE:
+      AppendPackage(bytes.substr(begin));
+      break;
+    case State::RESULTS:
+      break;
+  }
+
+  return absl::OkStatus();
+}
+
+void RpcResponseParser::AppendPackage(std::string_view bytes) {
+  if (filter_.has_value()) {
+    filter_->Append(bytes, &package_);
+  } else {
+    package_.append(bytes);
+  }
+}
 
+absl::Status RpcResponseParser::ParsePackage() {
+  Package package;
+  const auto ec = glz::read<kParseOpts>(package, package_, glz::context{});
+  if (ec) {
+    return absl::InvalidArgumentError("parse error: " +
+                                      glz::format_error(ec, package_));
+  }
+
+  packages_.push_back(std::move(package));
+  package_.clear();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<RpcResponse> RpcResponseParser::Finish() && {
+  if (!status_.ok()) {
+    return status_;
+  }
+  if (state_ != State::TOP_LEVEL) {
+    return absl::InvalidArgumentError(
+        "parse error: unexpected end of input in results");
+  }
+
+  // Everything but the packages themselves is validated here, and any error
+  // which the AUR sent instead of results is picked up.
   Raw raw;
-  const auto ec = glz::read<opts>(raw, bytes, glz::context{});
+  const auto ec = glz::read<kParseOpts>(raw, skeleton_, glz::context{});
   if (ec) {
     return absl::InvalidArgumentError("parse error: " +
-                                      glz::format_error(ec, bytes));
+                                      glz::format_error(ec, skeleton_));
   } else if (!raw.error.empty()) {
     return absl::UnknownError(raw.error);
   }
 
-  return RpcResponse(std::move(raw.packages));
+  return RpcResponse(std::move(packages_));
+}
+
+absl::StatusOr<MetadataResponse> MetadataResponse::Parse(
+    std::string_view bytes) {
+  std::string inflated;
+  if (IsGzipped(bytes)) {
+    auto gunzipped = Gunzip(bytes);
+    if (!gunzipped.ok()) {
+      return gunzipped.status();
+    }
+
+    inflated = std::move(gunzipped).value();
+    bytes = inflated;
+  }
+
+  std::vector<Package> packages;
+  const auto ec = glz::read<kParseOpts>(packages, bytes, glz::context{});
+  if (ec) {
+    return absl::InvalidArgumentError("parse error: " +
+                                      glz::format_error(ec, bytes));
+  }
+
+  return MetadataResponse(std::move(packages));
 }
 
 }  // namespace aur
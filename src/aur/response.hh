@@ -2,12 +2,16 @@
 #ifndef AUR_RESPONSE_HH_
 #define AUR_RESPONSE_HH_
 
+#include <cstdio>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "aur/package.hh"
+#include "aur/package_fields.hh"
 
 namespace aur {
 
@@ -28,7 +32,10 @@ struct CloneResponse {
 };
 
 struct RpcResponse {
-  static absl::StatusOr<RpcResponse> Parse(std::string_view bytes);
+  // Parses |bytes|, decoding only the members of each package that belong to
+  // |fields|. Everything else is left at its default.
+  static absl::StatusOr<RpcResponse> Parse(
+      std::string_view bytes, PackageFields fields = PackageFields::All());
 
   RpcResponse() = default;
   RpcResponse(std::vector<Package> packages) : packages(std::move(packages)) {}
@@ -42,6 +49,82 @@ struct RpcResponse {
   std::vector<Package> packages;
 };
 
+// RpcResponseParser parses an RPC response incrementally, as its bytes arrive.
+// Each package is decoded as soon as the last of its bytes has been seen, so
+// parsing overlaps with the transfer, and the full response body never needs
+// to be held in memory.
+class RpcResponseParser {
+ public:
+  // Only the members of each package that belong to |fields| are decoded. The
+  // others are dropped as they arrive, and are never copied or parsed.
+  explicit RpcResponseParser(PackageFields fields = PackageFields::All()) {
+    if (!fields.all()) {
+      filter_.emplace(std::move(fields));
+    }
+  }
+
+  RpcResponseParser(const RpcResponseParser&) = delete;
+  RpcResponseParser& operator=(const RpcResponseParser&) = delete;
+
+  RpcResponseParser(RpcResponseParser&&) = default;
+  RpcResponseParser& operator=(RpcResponseParser&&) = default;
+
+  // Parses the next chunk of the response. Once an error is returned, all
+  // further input is ignored and Finish returns the same error.
+  absl::Status Feed(std::string_view bytes);
+
+  // Completes parsing, returning the packages in the response or the error
+  // that the AUR returned instead.
+  absl::StatusOr<RpcResponse> Finish() &&;
+
+ private:
+  enum class State {
+    // Outside of the "results" array.
+    TOP_LEVEL,
+    // Between elements of the "results" array.
+    RESULTS,
+    // Inside of an element of the "results" array.
+    PACKAGE,
+  };
+
+  void AppendPackage(std::string_view bytes);
+  absl::Status ParsePackage();
+
+  State state_ = State::TOP_LEVEL;
+  int depth_ = 0;
+  bool in_string_ = false;
+  bool escaped_ = false;
+
+  // The response with the elements of the "results" array removed, and the
+  // package currently being received.
+  std::string skeleton_;
+  std::string package_;
+
+  // Set when only some fields are wanted.
+  std::optional<PackageFieldFilter> filter_;
+
+  std::vector<Package> packages_;
+  absl::Status status_;
+};
+
+// The AUR's full package metadata dump, as published in
+// packages-meta-ext-v1.json.gz. The dump may be given either compressed or
+// uncompressed.
+struct MetadataResponse {
+  static absl::StatusOr<MetadataResponse> Parse(std::string_view bytes);
+
+  MetadataResponse(std::vector<Package> packages)
+      : packages(std::move(packages)) {}
+
+  MetadataResponse(const MetadataResponse&) = delete;
+  MetadataResponse& operator=(const MetadataResponse&) = delete;
+
+  MetadataResponse(MetadataResponse&&) = default;
+  MetadataResponse& operator=(MetadataResponse&&) = default;
+
+  std::vector<Package> packages;
+};
+
 struct RawResponse {
   static absl::StatusOr<RawResponse> Parse(std::string bytes) {
     return RawResponse(std::move(bytes));
@@ -55,6 +138,13 @@ struct RawResponse {
   RawResponse(RawResponse&&) = default;
   RawResponse& operator=(RawResponse&&) = default;
 
+  // Writes the response and a trailing newline to |stream|, straight from
+  // |bytes| rather than through a formatted copy.
+  void WriteTo(std::FILE* stream) const {
+    std::fwrite(bytes.data(), 1, bytes.size(), stream);
+    std::fputc('\n', stream);
+  }
+
   std::string bytes;
 };
 
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "aur/response.hh"
+#include "aur/response_view.hh"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// Builds an RPC response holding |count| packages, each roughly the size of a
+// typical multiinfo result.
+std::string MakeRpcResponse(int count) {
+  std::vector<std::string> results;
+  results.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    const std::string name = absl::StrCat("package-", i);
+    results.push_back(absl::StrCat(
+        R"({"ID":)", 500000 + i, R"(,"Name":")", name,
+        R"(","PackageBaseID":)", 100000 + i, R"(,"PackageBase":")", name,
+        R"(","Version":"1.2.3-)", i % 10,
+        R"(","Description":"A package with an \"escaped\" description",)",
+        R"("URL":"https://example.com/)", name, R"(","NumVotes":)", i % 500,
+        R"(,"Popularity":0.095498,"OutOfDate":null,"Maintainer":"falconindy",)",
+        R"("Submitter":"falconindy","FirstSubmitted":1499013608,)",
+        R"("LastModified":1534000474,"URLPath":"/cgit/aur.git/snapshot/)",
+        name, R"(.tar.gz","Depends":["glibc","package-)", i + 1,
+        R"(>=1.0","libcurl.so"],"MakeDepends":["meson","git"],)",
+        R"("CheckDepends":["python"],"OptDepends":["bash: completion"],)",
+        R"("Conflicts":[")", name, R"(-git"],"Provides":[")", name,
+        R"(=1.2.3"],"License":["MIT"],"Keywords":["aur","helper"],)",
+        R"("CoMaintainers":["someone"]})"));
+  }
+
+  return absl::StrCat(R"({"version":5,"type":"multiinfo","resultcount":)",
+                      count, R"(,"results":[)", absl::StrJoin(results, ","),
+                      "]}");
+}
+
+void BM_RpcResponseParse(benchmark::State& state) {
+  const std::string bytes = MakeRpcResponse(state.range(0));
+
+  for (auto _ : state) {
+    auto response = aur::RpcResponse::Parse(bytes);
+    benchmark::DoNotOptimize(response);
+  }
+
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+BENCHMARK(BM_RpcResponseParse)->Arg(100)->Arg(1000)->Arg(5000);
+
+void BM_RpcResponseViewParse(benchmark::State& state) {
+  const std::string bytes = MakeRpcResponse(state.range(0));
+
+  for (auto _ : state) {
+    // The copy stands in for the body which the client hands over.
+    auto response = aur::RpcResponseView::Parse(bytes);
+    benchmark::DoNotOptimize(response);
+  }
+
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+BENCHMARK(BM_RpcResponseViewParse)->Arg(100)->Arg(1000)->Arg(5000);
+
+// Parses the response as it would arrive from the network.
+void BM_RpcResponseParserChunked(benchmark::State& state) {
+  const std::string bytes = MakeRpcResponse(5000);
+  const size_t chunk_size = state.range(0);
+
+  for (auto _ : state) {
+    aur::RpcResponseParser parser;
+    for (size_t i = 0; i < bytes.size(); i += chunk_size) {
+      benchmark::DoNotOptimize(
+          parser.Feed(std::string_view(bytes).substr(i, chunk_size)));
+    }
+    auto response = std::move(parser).Finish();
+    benchmark::DoNotOptimize(response);
+  }
+
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+BENCHMARK(BM_RpcResponseParserChunked)->Arg(1 << 10)->Arg(16 << 10);
+
+}  // namespace
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: MIT
+#include "aur/response_cache.hh"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace fs = std::filesystem;
+
+namespace aur {
+
+namespace {
+
+constexpr std::string_view kMagic = "auracle-response-cache-v1";
+
+// 64-bit FNV-1a. Unlike absl::Hash, this is stable across processes, which we
+// need in order to name files on disk.
+uint64_t Fingerprint(std::string_view url, std::string_view payload) {
+  uint64_t hash = 0xcbf29ce484222325;
+
+  const auto mix = [&hash](std::string_view bytes) {
+    for (const unsigned char c : bytes) {
+      hash ^= c;
+      hash *= 0x100000001b3;
+    }
+  };
+
+  mix(url);
+  mix(std::string_view("\0", 1));
+  mix(payload);
+
+  return hash;
+}
+
+// The full request is stored alongside the response so that fingerprint
+// collisions are detected rather than served.
+std::string RequestLine(std::string_view url, std::string_view payload) {
+  return absl::StrCat(url, " ", payload);
+}
+
+}  // namespace
+
+std::string ResponseCache::PathFor(std::string_view url,
+                                   std::string_view payload) const {
+  return (fs::path(directory_) /
+          absl::StrFormat("%016x", Fingerprint(url, payload)))
+      .string();
+}
+
+std::optional<ResponseCache::Entry> ResponseCache::Lookup(
+    std::string_view url, std::string_view payload) const {
+  std::ifstream file(PathFor(url, payload), std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+
+  Entry entry;
+  std::string magic, request, fetched;
+  if (!std::getline(file, magic) || magic != kMagic ||
+      !std::getline(file, request) || request != RequestLine(url, payload) ||
+      !std::getline(file, fetched) || !std::getline(file, entry.etag) ||
+      !std::getline(file, entry.last_modified)) {
+    return std::nullopt;
+  }
+
+  int64_t seconds;
+  if (!absl::SimpleAtoi(fetched, &seconds)) {
+    return std::nullopt;
+  }
+  entry.fetched = absl::FromUnixSeconds(seconds);
+
+  entry.body.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+
+  return entry;
+}
+
+absl::Status ResponseCache::Store(std::string_view url,
+                                  std::string_view payload,
+                                  const Entry& entry) const {
+  std::error_code ec;
+  fs::create_directories(directory_, ec);
+  if (ec.value() != 0) {
+    return absl::InternalError(absl::StrCat(
+        "failed to create cache directory ", directory_, ": ", ec.message()));
+  }
+
+  // Write to a temporary file and rename it into place so that concurrent
+  // readers never observe a partially written entry.
+  const std::string path = PathFor(url, payload);
+  const std::string tmppath = absl::StrCat(path, ".", getpid());
+
+  std::ofstream file(tmppath, std::ios::binary | std::ios::trunc);
+  file << kMagic << '\n'
+       << RequestLine(url, payload) << '\n'
+       << absl::ToUnixSeconds(entry.fetched) << '\n'
+       << entry.etag << '\n'
+       << entry.last_modified << '\n'
+       << entry.body;
+  file.close();
+
+  if (!file) {
+    fs::remove(tmppath, ec);
+    return absl::InternalError(
+        absl::StrCat("failed to write cache entry ", tmppath));
+  }
+
+  fs::rename(tmppath, path, ec);
+  if (ec.value() != 0) {
+    fs::remove(tmppath, ec);
+    return absl::InternalError(absl::StrCat("failed to write cache entry ",
+                                            path, ": ", ec.message()));
+  }
+
+  return absl::OkStatus();
+}
+
+}  // namespace aur
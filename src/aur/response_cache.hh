@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_RESPONSE_CACHE_HH_
+#define AUR_RESPONSE_CACHE_HH_
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+
+namespace aur {
+
+// ResponseCache persists HTTP response bodies on disk, along with the
+// validators needed to conditionally revalidate them with the server. Entries
+// are keyed by the request's URL and payload.
+class ResponseCache {
+ public:
+  struct Entry {
+    // The time at which the response was last fetched or revalidated.
+    absl::Time fetched;
+
+    // Validators sent by the server, possibly empty.
+    std::string etag;
+    std::string last_modified;
+
+    std::string body;
+  };
+
+  explicit ResponseCache(std::string directory)
+      : directory_(std::move(directory)) {}
+
+  ResponseCache(const ResponseCache&) = default;
+  ResponseCache& operator=(const ResponseCache&) = default;
+
+  ResponseCache(ResponseCache&&) = default;
+  ResponseCache& operator=(ResponseCache&&) = default;
+
+  // Returns the cached entry for the given request, if any.
+  std::optional<Entry> Lookup(std::string_view url,
+                              std::string_view payload) const;
+
+  // Stores |entry| as the response to the given request, replacing any
+  // existing entry.
+  absl::Status Store(std::string_view url, std::string_view payload,
+                     const Entry& entry) const;
+
+ private:
+  std::string PathFor(std::string_view url, std::string_view payload) const;
+
+  std::string directory_;
+};
+
+}  // namespace aur
+
+#endif  // AUR_RESPONSE_CACHE_HH_
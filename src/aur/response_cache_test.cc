@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+#include "aur/response_cache.hh"
+
+#include <filesystem>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace fs = std::filesystem;
+
+using aur::ResponseCache;
+using testing::Field;
+using testing::Optional;
+
+class ResponseCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = fs::path(testing::TempDir()) /
+                 testing::UnitTest::GetInstance()->current_test_info()->name();
+    fs::remove_all(directory_);
+  }
+
+  void TearDown() override { fs::remove_all(directory_); }
+
+  fs::path directory_;
+};
+
+TEST_F(ResponseCacheTest, MissesUnknownRequests) {
+  ResponseCache cache(directory_);
+
+  EXPECT_EQ(cache.Lookup("http://a.b/rpc/v5/info", "arg[]=foo"), std::nullopt);
+}
+
+TEST_F(ResponseCacheTest, StoresAndLooksUpEntries) {
+  ResponseCache cache(directory_);
+
+  ResponseCache::Entry entry;
+  entry.fetched = absl::FromUnixSeconds(1700000000);
+  entry.etag = R"("deadbeef")";
+  entry.last_modified = "Tue, 14 Nov 2023 22:13:20 GMT";
+  entry.body = "{\"results\": []}\n\nwith trailing lines\n";
+
+  ASSERT_TRUE(cache.Store("http://a.b/rpc/v5/info", "arg[]=foo", entry).ok());
+
+  const auto cached = cache.Lookup("http://a.b/rpc/v5/info", "arg[]=foo");
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->fetched, entry.fetched);
+  EXPECT_EQ(cached->etag, entry.etag);
+  EXPECT_EQ(cached->last_modified, entry.last_modified);
+  EXPECT_EQ(cached->body, entry.body);
+}
+
+TEST_F(ResponseCacheTest, KeysOnUrlAndPayload) {
+  ResponseCache cache(directory_);
+
+  ResponseCache::Entry entry;
+  entry.body = "foo";
+  ASSERT_TRUE(cache.Store("http://a.b/rpc/v5/info", "arg[]=foo", entry).ok());
+
+  EXPECT_EQ(cache.Lookup("http://a.b/rpc/v5/info", "arg[]=bar"), std::nullopt);
+  EXPECT_EQ(cache.Lookup("http://a.b/rpc/v5/search", "arg[]=foo"),
+            std::nullopt);
+}
+
+TEST_F(ResponseCacheTest, ReplacesExistingEntries) {
+  ResponseCache cache(directory_);
+
+  ResponseCache::Entry entry;
+  entry.body = "foo";
+  ASSERT_TRUE(cache.Store("http://a.b/rpc/v5/info", "", entry).ok());
+
+  entry.body = "bar";
+  ASSERT_TRUE(cache.Store("http://a.b/rpc/v5/info", "", entry).ok());
+
+  EXPECT_THAT(cache.Lookup("http://a.b/rpc/v5/info", ""),
+              Optional(Field(&ResponseCache::Entry::body, "bar")));
+}
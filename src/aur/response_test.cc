@@ -1,9 +1,13 @@
 // SPDX-License-Identifier: MIT
 #include "aur/response.hh"
 
+#include <cstdio>
+#include <cstdlib>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using aur::RawResponse;
 using aur::RpcResponse;
 using testing::Field;
 using testing::UnorderedElementsAre;
@@ -123,3 +127,89 @@ TEST(ResponseTest, GracefullyHandlesInvalidJson) {
 
   ASSERT_THAT(response.status().message(), testing::HasSubstr("parse error"));
 }
+
+TEST(ResponseTest, ParsesResponsesIncrementally) {
+  constexpr std::string_view kResponse = R"({
+    "version": 5,
+    "type": "search",
+    "resultcount": 2,
+    "results": [
+      {
+        "Name": "auracle-git",
+        "Description": "braces { and brackets ] in \"strings\"",
+        "Depends": ["pacman"]
+      },
+      {
+        "Name": "pkgfile-git",
+        "Depends": []
+      }
+    ]
+  })";
+
+  aur::RpcResponseParser parser;
+  for (char c : kResponse) {
+    ASSERT_TRUE(parser.Feed(std::string_view(&c, 1)).ok());
+  }
+
+  const auto response = std::move(parser).Finish();
+  ASSERT_TRUE(response.ok()) << response.status();
+  EXPECT_THAT(
+      response->packages,
+      testing::ElementsAre(Field(&aur::Package::name, "auracle-git"),
+                           Field(&aur::Package::name, "pkgfile-git")));
+  EXPECT_EQ(response->packages[0].description,
+            R"(braces { and brackets ] in "strings")");
+}
+
+TEST(ResponseTest, ParsesOnlyRequestedFields) {
+  const auto response = RpcResponse::Parse(
+      R"({
+    "version": 5,
+    "type": "search",
+    "resultcount": 1,
+    "results": [
+      {
+        "ID": 1123,
+        "Description": "unwanted, with \"Name\": \"decoy\"",
+        "Name": "auracle-git",
+        "Depends": ["pacman", "libarchive.so"],
+        "Version": "r74.82e863f-1",
+        "Keywords": []
+      }
+    ]
+  })",
+      aur::PackageFields({aur::PackageField::NAME,
+                          aur::PackageField::VERSION}));
+
+  ASSERT_TRUE(response.ok()) << response.status();
+  ASSERT_EQ(response->packages.size(), 1);
+
+  const auto& package = response->packages[0];
+  EXPECT_EQ(package.package_id, 1123);
+  EXPECT_EQ(package.name, "auracle-git");
+  EXPECT_EQ(package.version, "r74.82e863f-1");
+  EXPECT_EQ(package.description, "");
+  EXPECT_THAT(package.depends, testing::IsEmpty());
+}
+
+TEST(ResponseTest, RejectsTruncatedResponses) {
+  aur::RpcResponseParser parser;
+  ASSERT_TRUE(parser.Feed(R"({"results": [{"Name": "auracle-git"},)").ok());
+
+  const auto response = std::move(parser).Finish();
+  EXPECT_THAT(response.status().message(), testing::HasSubstr("parse error"));
+}
+
+TEST(ResponseTest, WritesRawResponses) {
+  char* buffer = nullptr;
+  size_t size = 0;
+  std::FILE* stream = open_memstream(&buffer, &size);
+  ASSERT_NE(stream, nullptr);
+
+  RawResponse(std::string("pkgname=auracle\0git", 19)).WriteTo(stream);
+  std::fclose(stream);
+
+  EXPECT_EQ(std::string_view(buffer, size),
+            std::string_view("pkgname=auracle\0git\n", 20));
+  std::free(buffer);
+}
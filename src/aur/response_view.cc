@@ -0,0 +1,610 @@
+// SPDX-License-Identifier: MIT
+#include "aur/response_view.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+
+namespace aur {
+
+namespace {
+
+// The fields of a package, as named by the RPC interface.
+struct StringField {
+  std::string_view key;
+  std::string_view RpcPackageView::* field;
+};
+
+constexpr StringField kStringFields[] = {
+    {"Description", &RpcPackageView::description},
+    {"Maintainer", &RpcPackageView::maintainer},
+    {"Name", &RpcPackageView::name},
+    {"PackageBase", &RpcPackageView::pkgbase},
+    {"Submitter", &RpcPackageView::submitter},
+    {"URL", &RpcPackageView::upstream_url},
+    {"URLPath", &RpcPackageView::aur_urlpath},
+    {"Version", &RpcPackageView::version},
+};
+
+struct IntField {
+  std::string_view key;
+  int RpcPackageView::* field;
+};
+
+constexpr IntField kIntFields[] = {
+    {"ID", &RpcPackageView::package_id},
+    {"NumVotes", &RpcPackageView::votes},
+    {"PackageBaseID", &RpcPackageView::pkgbase_id},
+};
+
+struct TimeField {
+  std::string_view key;
+  absl::Time RpcPackageView::* field;
+};
+
+constexpr TimeField kTimeFields[] = {
+    {"FirstSubmitted", &RpcPackageView::submitted},
+    {"LastModified", &RpcPackageView::modified},
+    {"OutOfDate", &RpcPackageView::out_of_date},
+};
+
+struct ListField {
+  std::string_view key;
+  std::span<const std::string_view> RpcPackageView::* field;
+  std::vector<std::string> Package::* package_field;
+};
+
+constexpr ListField kListFields[] = {
+    {"CheckDepends", &RpcPackageView::checkdepends, &Package::checkdepends},
+    {"CoMaintainers", &RpcPackageView::comaintainers, &Package::comaintainers},
+    {"Conflicts", &RpcPackageView::conflicts, &Package::conflicts},
+    {"Depends", &RpcPackageView::depends, &Package::depends},
+    {"Groups", &RpcPackageView::groups, &Package::groups},
+    {"Keywords", &RpcPackageView::keywords, &Package::keywords},
+    {"License", &RpcPackageView::licenses, &Package::licenses},
+    {"MakeDepends", &RpcPackageView::makedepends, &Package::makedepends},
+    {"OptDepends", &RpcPackageView::optdepends, &Package::optdepends},
+    {"Provides", &RpcPackageView::provides, &Package::provides},
+    {"Replaces", &RpcPackageView::replaces, &Package::replaces},
+};
+
+constexpr int kMaxDepth = 64;
+
+// Where each list of a package lies in the shared list storage, which may
+// still move while parsing is under way.
+using ListRanges =
+    std::array<std::pair<size_t, size_t>, std::size(kListFields)>;
+
+char* EncodeUtf8(uint32_t cp, char* out) {
+  if (cp < 0x80) {
+    *out++ = cp;
+  } else if (cp < 0x800) {
+    *out++ = 0xc0 | (cp >> 6);
+    *out++ = 0x80 | (cp & 0x3f);
+  } else if (cp < 0x10000) {
+    *out++ = 0xe0 | (cp >> 12);
+    *out++ = 0x80 | ((cp >> 6) & 0x3f);
+    *out++ = 0x80 | (cp & 0x3f);
+  } else {
+    *out++ = 0xf0 | (cp >> 18);
+    *out++ = 0x80 | ((cp >> 12) & 0x3f);
+    *out++ = 0x80 | ((cp >> 6) & 0x3f);
+    *out++ = 0x80 | (cp & 0x3f);
+  }
+  return out;
+}
+
+// ViewParser reads an RPC response, unescaping strings over the top of the
+// input. An escape sequence is never shorter than what it decodes to, so the
+// output never catches up with the input still to be read.
+class ViewParser {
+ public:
+  ViewParser(std::string& bytes, const PackageFields& fields)
+      : fields_(fields),
+        begin_(bytes.data()),
+        pos_(begin_),
+        end_(begin_ + bytes.size()) {}
+
+  absl::Status ParseResponse(std::vector<RpcPackageView>* packages,
+                             std::vector<ListRanges>* ranges,
+                             std::vector<std::string_view>* lists,
+                             std::string_view* error) {
+    auto status = ParseObject([&](std::string_view key) {
+      if (key == "results") {
+        return ParseResults(packages, ranges, lists);
+      } else if (key == "error") {
+        return ParseNullable([&] { return ParseString(error); });
+      }
+      return SkipValue(0);
+    });
+    if (!status.ok()) {
+      return status;
+    }
+
+    SkipWhitespace();
+    if (pos_ != end_) {
+      return Error("unexpected trailing characters");
+    }
+
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::Status Error(std::string_view what) const {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("parse error: %s at offset %d", what, pos_ - begin_));
+  }
+
+  void SkipWhitespace() {
+    while (pos_ != end_ &&
+           (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (pos_ == end_ || *pos_ != c) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  bool ConsumeLiteral(std::string_view literal) {
+    SkipWhitespace();
+    if (std::string_view(pos_, end_ - pos_).substr(0, literal.size()) !=
+        literal) {
+      return false;
+    }
+    pos_ += literal.size();
+    return true;
+  }
+
+  // Leaves the value at its default when it's null.
+  template <typename F>
+  absl::Status ParseNullable(F&& parse) {
+    if (ConsumeLiteral("null")) {
+      return absl::OkStatus();
+    }
+    return std::forward<F>(parse)();
+  }
+
+  // Calls |member| for each key of an object, which must consume the value.
+  template <typename F>
+  absl::Status ParseObject(F&& member) {
+    if (!Consume('{')) {
+      return Error("expected object");
+    }
+    if (Consume('}')) {
+      return absl::OkStatus();
+    }
+
+    do {
+      std::string_view key;
+      if (auto status = ParseString(&key); !status.ok()) {
+        return status;
+      }
+      if (!Consume(':')) {
+        return Error("expected ':'");
+      }
+      if (auto status = member(key); !status.ok()) {
+        return status;
+      }
+    } while (Consume(','));
+
+    if (!Consume('}')) {
+      return Error("expected ',' or '}'");
+    }
+    return absl::OkStatus();
+  }
+
+  // Calls |element| for each element of an array, which must consume it.
+  template <typename F>
+  absl::Status ParseArray(F&& element) {
+    if (!Consume('[')) {
+      return Error("expected array");
+    }
+    if (Consume(']')) {
+      return absl::OkStatus();
+    }
+
+    do {
+      if (auto status = element(); !status.ok()) {
+        return status;
+      }
+    } while (Consume(','));
+
+    if (!Consume(']')) {
+      return Error("expected ',' or ']'");
+    }
+    return absl::OkStatus();
+  }
+
+  bool ParseHex4(uint32_t* out) {
+    if (end_ - pos_ < 4) {
+      return false;
+    }
+
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = *pos_++;
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        value |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        value |= c - 'A' + 10;
+      } else {
+        return false;
+      }
+    }
+
+    *out = value;
+    return true;
+  }
+
+  absl::Status ParseString(std::string_view* out) {
+    if (!Consume('"')) {
+      return Error("expected string");
+    }
+
+    // Until the first escape, the string is left exactly where it is.
+    char* const begin = pos_;
+    char* write = nullptr;
+    while (pos_ != end_) {
+      const char c = *pos_;
+      if (c == '"') {
+        *out = std::string_view(begin, (write ? write : pos_) - begin);
+        ++pos_;
+        return absl::OkStatus();
+      }
+
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return Error("unescaped control character in string");
+      }
+
+      if (c != '\\') {
+        if (write != nullptr) {
+          *write++ = c;
+        }
+        ++pos_;
+        continue;
+      }
+
+      if (write == nullptr) {
+        write = pos_;
+      }
+      if (++pos_ == end_) {
+        break;
+      }
+
+      switch (const char e = *pos_++) {
+        case '"':
+        case '\\':
+        case '/':
+          *write++ = e;
+          break;
+        case 'b':
+          *write++ = '\b';
+          break;
+        case 'f':
+          *write++ = '\f';
+          break;
+        case 'n':
+          *write++ = '\n';
+          break;
+        case 'r':
+          *write++ = '\r';
+          break;
+        case 't':
+          *write++ = '\t';
+          break;
+        case 'u': {
+          uint32_t cp;
+          if (!ParseHex4(&cp)) {
+            return Error("invalid unicode escape");
+          }
+          if (cp >= 0xdc00 && cp <= 0xdfff) {
+            return Error("unpaired surrogate in unicode escape");
+          }
+          if (cp >= 0xd800 && cp <= 0xdbff) {
+            uint32_t low;
+            if (end_ - pos_ < 2 || pos_[0] != '\\' || pos_[1] != 'u') {
+              return Error("unpaired surrogate in unicode escape");
+            }
+            pos_ += 2;
+            if (!ParseHex4(&low) || low < 0xdc00 || low > 0xdfff) {
+              return Error("unpaired surrogate in unicode escape");
+            }
+            cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+          }
+          write = EncodeUtf8(cp, write);
+          break;
+        }
+        default:
+          return Error("invalid escape in string");
+      }
+    }
+
+    return Error("unterminated string");
+  }
+
+  std::string_view ScanNumber() {
+    SkipWhitespace();
+    const char* begin = pos_;
+    while (pos_ != end_ && ((*pos_ >= '0' && *pos_ <= '9') || *pos_ == '-' ||
+                            *pos_ == '+' || *pos_ == '.' || *pos_ == 'e' ||
+                            *pos_ == 'E')) {
+      ++pos_;
+    }
+    return std::string_view(begin, pos_ - begin);
+  }
+
+  template <typename T>
+  absl::Status ParseInt(T* out) {
+    if (!absl::SimpleAtoi(ScanNumber(), out)) {
+      return Error("expected integer");
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status ParseDouble(double* out) {
+    if (!absl::SimpleAtod(ScanNumber(), out)) {
+      return Error("expected number");
+    }
+    return absl::OkStatus();
+  }
+
+  // Steps over a string without unescaping it, as nothing will read it. Its
+  // escape sequences aren't checked.
+  absl::Status SkipString() {
+    ++pos_;
+    while (pos_ != end_) {
+      const char c = *pos_++;
+      if (c == '"') {
+        return absl::OkStatus();
+      }
+
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return Error("unescaped control character in string");
+      }
+
+      if (c == '\\' && pos_ != end_) {
+        ++pos_;
+      }
+    }
+
+    return Error("unterminated string");
+  }
+
+  absl::Status SkipValue(int depth) {
+    if (depth > kMaxDepth) {
+      return Error("nesting too deep");
+    }
+
+    SkipWhitespace();
+    if (pos_ == end_) {
+      return Error("unexpected end of input");
+    }
+
+    switch (*pos_) {
+      case '{':
+        return ParseObject([&](std::string_view) {
+          return SkipValue(depth + 1);
+        });
+      case '[':
+        return ParseArray([&] { return SkipValue(depth + 1); });
+      case '"':
+        return SkipString();
+    }
+
+    if (ConsumeLiteral("null") || ConsumeLiteral("true") ||
+        ConsumeLiteral("false")) {
+      return absl::OkStatus();
+    }
+
+    double unused;
+    return ParseDouble(&unused);
+  }
+
+  absl::Status ParseList(std::vector<std::string_view>* lists,
+                         std::pair<size_t, size_t>* range) {
+    range->first = lists->size();
+    auto status = ParseArray([&] {
+      return ParseString(&lists->emplace_back());
+    });
+    range->second = lists->size() - range->first;
+    return status;
+  }
+
+  absl::Status ParsePackage(RpcPackageView* package, ListRanges* ranges,
+                            std::vector<std::string_view>* lists) {
+    return ParseObject([&](std::string_view key) -> absl::Status {
+      if (!fields_.ContainsKey(key)) {
+        return SkipValue(0);
+      }
+
+      for (const auto& f : kStringFields) {
+        if (key == f.key) {
+          return ParseNullable(
+              [&] { return ParseString(&(package->*f.field)); });
+        }
+      }
+      for (const auto& f : kIntFields) {
+        if (key == f.key) {
+          return ParseNullable([&] { return ParseInt(&(package->*f.field)); });
+        }
+      }
+      for (const auto& f : kTimeFields) {
+        if (key == f.key) {
+          return ParseNullable([&]() -> absl::Status {
+            int64_t seconds;
+            if (auto status = ParseInt(&seconds); !status.ok()) {
+              return status;
+            }
+            package->*f.field = absl::FromUnixSeconds(seconds);
+            return absl::OkStatus();
+          });
+        }
+      }
+      for (size_t i = 0; i < std::size(kListFields); ++i) {
+        if (key == kListFields[i].key) {
+          return ParseNullable([&] { return ParseList(lists, &(*ranges)[i]); });
+        }
+      }
+      if (key == "Popularity") {
+        return ParseNullable([&] { return ParseDouble(&package->popularity); });
+      }
+      return SkipValue(0);
+    });
+  }
+
+  absl::Status ParseResults(std::vector<RpcPackageView>* packages,
+                            std::vector<ListRanges>* ranges,
+                            std::vector<std::string_view>* lists) {
+    return ParseNullable([&] {
+      return ParseArray([&] {
+        return ParsePackage(&packages->emplace_back(), &ranges->emplace_back(),
+                            lists);
+      });
+    });
+  }
+
+  const PackageFields& fields_;
+
+  char* const begin_;
+  char* pos_;
+  char* const end_;
+};
+
+std::vector<std::string> ToStrings(std::span<const std::string_view> views) {
+  return std::vector<std::string>(views.begin(), views.end());
+}
+
+}  // namespace
+
+Package RpcPackageView::ToPackage() const {
+  Package p;
+
+  p.name = name;
+  p.description = description;
+  p.submitter = submitter;
+  p.maintainer = maintainer;
+  p.pkgbase = pkgbase;
+  p.upstream_url = upstream_url;
+  p.aur_urlpath = aur_urlpath;
+  p.version = version;
+
+  p.package_id = package_id;
+  p.pkgbase_id = pkgbase_id;
+  p.votes = votes;
+  p.popularity = popularity;
+
+  p.out_of_date = out_of_date;
+  p.submitted = submitted;
+  p.modified = modified;
+
+  for (const auto& f : kListFields) {
+    p.*f.package_field = ToStrings(this->*f.field);
+  }
+
+  return p;
+}
+
+absl::StatusOr<RpcResponseView> RpcResponseView::Parse(
+    std::string bytes, const PackageFields& fields) {
+  auto arena = std::make_unique<Arena>();
+  arena->bytes = std::move(bytes);
+
+  std::vector<RpcPackageView> packages;
+  std::vector<ListRanges> ranges;
+  std::string_view error;
+  auto status = ViewParser(arena->bytes, fields)
+                    .ParseResponse(&packages, &ranges, &arena->lists, &error);
+  if (!status.ok()) {
+    return status;
+  } else if (!error.empty()) {
+    return absl::UnknownError(error);
+  }
+
+  // The lists have stopped moving, so they can finally be pointed at.
+  const std::span<const std::string_view> lists = arena->lists;
+  for (size_t i = 0; i < packages.size(); ++i) {
+    for (size_t j = 0; j < std::size(kListFields); ++j) {
+      const auto [offset, count] = ranges[i][j];
+      packages[i].*kListFields[j].field = lists.subspan(offset, count);
+    }
+  }
+
+  RpcResponseView response;
+  response.packages = std::move(packages);
+  response.arenas_.push_back(std::move(arena));
+  return response;
+}
+
+RpcResponseView RpcResponseView::FromPackages(std::vector<Package> packages) {
+  auto arena = std::make_unique<Arena>();
+  arena->packages = std::move(packages);
+
+  // Reserved up front, so that spans can be taken as the lists are filled.
+  size_t size = 0;
+  for (const auto& p : arena->packages) {
+    for (const auto& f : kListFields) {
+      size += (p.*f.package_field).size();
+    }
+  }
+  arena->lists.reserve(size);
+
+  RpcResponseView response;
+  response.packages.reserve(arena->packages.size());
+  for (const auto& p : arena->packages) {
+    auto& v = response.packages.emplace_back();
+
+    v.name = p.name;
+    v.description = p.description;
+    v.submitter = p.submitter;
+    v.maintainer = p.maintainer;
+    v.pkgbase = p.pkgbase;
+    v.upstream_url = p.upstream_url;
+    v.aur_urlpath = p.aur_urlpath;
+    v.version = p.version;
+
+    v.package_id = p.package_id;
+    v.pkgbase_id = p.pkgbase_id;
+    v.votes = p.votes;
+    v.popularity = p.popularity;
+
+    v.out_of_date = p.out_of_date;
+    v.submitted = p.submitted;
+    v.modified = p.modified;
+
+    for (const auto& f : kListFields) {
+      const size_t offset = arena->lists.size();
+      for (const auto& s : p.*f.package_field) {
+        arena->lists.emplace_back(s);
+      }
+      v.*f.field = std::span<const std::string_view>(arena->lists)
+                       .subspan(offset, arena->lists.size() - offset);
+    }
+  }
+
+  response.arenas_.push_back(std::move(arena));
+  return response;
+}
+
+void RpcResponseView::Append(RpcResponseView other) {
+  packages.insert(packages.end(), other.packages.begin(),
+                  other.packages.end());
+  std::move(other.arenas_.begin(), other.arenas_.end(),
+            std::back_inserter(arenas_));
+}
+
+}  // namespace aur
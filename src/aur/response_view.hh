@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_RESPONSE_VIEW_HH_
+#define AUR_RESPONSE_VIEW_HH_
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "aur/package.hh"
+#include "aur/package_fields.hh"
+
+namespace aur {
+
+// RpcPackageView has the same fields as Package, but owns none of its strings.
+// They belong to the RpcResponseView which the package came from, and are only
+// valid for as long as it is. Unlike a PackageView into a PackageIndex, fields
+// are plain members, so code can be written once for both this and Package.
+struct RpcPackageView {
+  RpcPackageView() = default;
+
+  std::string_view name;
+  std::string_view description;
+  std::string_view submitter;
+  std::string_view maintainer;
+  std::string_view pkgbase;
+  std::string_view upstream_url;
+  std::string_view aur_urlpath;
+  std::string_view version;
+
+  int package_id = 0;
+  int pkgbase_id = 0;
+  int votes = 0;
+  double popularity = 0.f;
+
+  absl::Time out_of_date;
+  absl::Time submitted;
+  absl::Time modified;
+
+  std::span<const std::string_view> conflicts;
+  std::span<const std::string_view> groups;
+  std::span<const std::string_view> keywords;
+  std::span<const std::string_view> licenses;
+  std::span<const std::string_view> optdepends;
+  std::span<const std::string_view> provides;
+  std::span<const std::string_view> replaces;
+  std::span<const std::string_view> comaintainers;
+
+  std::span<const std::string_view> depends;
+  std::span<const std::string_view> makedepends;
+  std::span<const std::string_view> checkdepends;
+
+  // Copies the package into storage of its own.
+  Package ToPackage() const;
+};
+
+inline bool operator==(const RpcPackageView& a, const RpcPackageView& b) {
+  return a.package_id == b.package_id && a.pkgbase_id == b.pkgbase_id;
+}
+
+// RpcResponseView is an RpcResponse whose packages are RpcPackageViews. The
+// response body is kept, strings are unescaped in place and referred to where
+// they lie, and the elements of every list share a single allocation. Parsing
+// a response therefore costs a handful of allocations, however many packages
+// it holds, rather than one for every string in every package.
+class RpcResponseView {
+ public:
+  // The values of members of a package outside of |fields| are skipped over
+  // without being unescaped or stored, and their views are left empty.
+  static absl::StatusOr<RpcResponseView> Parse(
+      std::string bytes, const PackageFields& fields = PackageFields::All());
+
+  // Wraps packages which have already been decoded, e.g. by an offline index.
+  static RpcResponseView FromPackages(std::vector<Package> packages);
+
+  RpcResponseView() = default;
+
+  RpcResponseView(const RpcResponseView&) = delete;
+  RpcResponseView& operator=(const RpcResponseView&) = delete;
+
+  RpcResponseView(RpcResponseView&&) = default;
+  RpcResponseView& operator=(RpcResponseView&&) = default;
+
+  // Takes the packages of |other|, along with the storage behind them.
+  void Append(RpcResponseView other);
+
+  std::vector<RpcPackageView> packages;
+
+ private:
+  // Holds the strings which views point into. Arenas live on the heap, so
+  // that views survive the response being moved.
+  struct Arena {
+    std::string bytes;
+    std::vector<Package> packages;
+    std::vector<std::string_view> lists;
+  };
+
+  std::vector<std::unique_ptr<Arena>> arenas_;
+};
+
+}  // namespace aur
+
+#endif  // AUR_RESPONSE_VIEW_HH_
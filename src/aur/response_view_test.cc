@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: MIT
+#include "aur/response_view.hh"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using aur::Package;
+using aur::RpcPackageView;
+using aur::RpcResponseView;
+using testing::ElementsAre;
+using testing::HasSubstr;
+using testing::IsEmpty;
+
+TEST(ResponseViewTest, ParsesSuccessResponse) {
+  auto response = RpcResponseView::Parse(R"({
+    "version": 5,
+    "type": "multiinfo",
+    "resultcount": 2,
+    "results": [
+      {
+        "ID": 534056,
+        "Name": "auracle-git",
+        "PackageBaseID": 123768,
+        "PackageBase": "auracle-git",
+        "Version": "r36.752e4ba-1",
+        "Description": "A flexible client for the AUR",
+        "URL": "https://github.com/falconindy/auracle.git",
+        "NumVotes": 15,
+        "Popularity": 0.095498,
+        "OutOfDate": null,
+        "Maintainer": "falconindy",
+        "FirstSubmitted": 1499013608,
+        "LastModified": 1534000474,
+        "URLPath": "/cgit/aur.git/snapshot/auracle-git.tar.gz",
+        "Depends": ["pacman", "libarchive.so", "libcurl.so"],
+        "MakeDepends": ["meson", "git"],
+        "License": ["MIT"],
+        "Keywords": [],
+        "Unknown": {"nested": [1, true, {"deeper": "still"}]}
+      },
+      {
+        "ID": 1,
+        "Name": "pkgfile",
+        "PackageBaseID": 2,
+        "Maintainer": null,
+        "Provides": ["pkgfile-git"]
+      }
+    ]
+  })");
+  ASSERT_TRUE(response.ok()) << response.status();
+  ASSERT_EQ(response->packages.size(), 2);
+
+  const auto& p = response->packages[0];
+  EXPECT_EQ(p.package_id, 534056);
+  EXPECT_EQ(p.name, "auracle-git");
+  EXPECT_EQ(p.pkgbase_id, 123768);
+  EXPECT_EQ(p.pkgbase, "auracle-git");
+  EXPECT_EQ(p.version, "r36.752e4ba-1");
+  EXPECT_EQ(p.description, "A flexible client for the AUR");
+  EXPECT_EQ(p.upstream_url, "https://github.com/falconindy/auracle.git");
+  EXPECT_EQ(p.votes, 15);
+  EXPECT_EQ(p.popularity, 0.095498);
+  EXPECT_EQ(p.out_of_date, absl::FromUnixSeconds(0));
+  EXPECT_EQ(p.maintainer, "falconindy");
+  EXPECT_EQ(p.submitted, absl::FromUnixSeconds(1499013608));
+  EXPECT_EQ(p.modified, absl::FromUnixSeconds(1534000474));
+  EXPECT_EQ(p.aur_urlpath, "/cgit/aur.git/snapshot/auracle-git.tar.gz");
+  EXPECT_THAT(p.depends, ElementsAre("pacman", "libarchive.so", "libcurl.so"));
+  EXPECT_THAT(p.makedepends, ElementsAre("meson", "git"));
+  EXPECT_THAT(p.licenses, ElementsAre("MIT"));
+  EXPECT_THAT(p.keywords, IsEmpty());
+  EXPECT_THAT(p.provides, IsEmpty());
+
+  const auto& q = response->packages[1];
+  EXPECT_EQ(q.name, "pkgfile");
+  EXPECT_EQ(q.maintainer, "");
+  EXPECT_THAT(q.provides, ElementsAre("pkgfile-git"));
+  EXPECT_THAT(q.depends, IsEmpty());
+}
+
+TEST(ResponseViewTest, UnescapesStrings) {
+  auto response = RpcResponseView::Parse(
+      R"({"results":[{"Name":"plain","Description":)"
+      R"("\"quoted\" \\ \/ \t\u00e9\u20AC\ud83d\ude00 end",)"
+      R"("Depends":["a\nb", "A"]}]})");
+  ASSERT_TRUE(response.ok()) << response.status();
+  ASSERT_EQ(response->packages.size(), 1);
+
+  const auto& p = response->packages[0];
+  EXPECT_EQ(p.name, "plain");
+  EXPECT_EQ(p.description,
+            "\"quoted\" \\ / \t\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80 end");
+  EXPECT_THAT(p.depends, ElementsAre("a\nb", "A"));
+}
+
+TEST(ResponseViewTest, ParsesErrorResponse) {
+  auto response = RpcResponseView::Parse(R"({
+    "version": 5,
+    "type": "error",
+    "resultcount": 0,
+    "results": [],
+    "error": "Too many package results."
+  })");
+  EXPECT_TRUE(absl::IsUnknown(response.status()));
+  EXPECT_EQ(response.status().message(), "Too many package results.");
+}
+
+TEST(ResponseViewTest, RejectsInvalidInput) {
+  for (const char* bytes : {
+           "",
+           "[]",
+           R"({"results":[{"Name":"auracle"}])",
+           R"({"results":[{"Name":"auracle"}]} trailing)",
+           R"({"results":[{"Name":"unterminated}]})",
+           R"({"results":[{"Name":"\x"}]})",
+           R"({"results":[{"Name":"\ud83d"}]})",
+           R"({"results":[{"ID":"not a number"}]})",
+           R"({"results":[{"Depends":"not a list"}]})",
+       }) {
+    auto response = RpcResponseView::Parse(bytes);
+    EXPECT_TRUE(absl::IsInvalidArgument(response.status())) << bytes;
+    EXPECT_THAT(response.status().message(), HasSubstr("parse error")) << bytes;
+  }
+
+  const std::string deep = std::string(100, '[') + std::string(100, ']');
+  auto response = RpcResponseView::Parse(R"({"x":)" + deep + "}");
+  EXPECT_TRUE(absl::IsInvalidArgument(response.status()));
+}
+
+TEST(ResponseViewTest, ParsesOnlyRequestedFields) {
+  auto response = RpcResponseView::Parse(
+      R"({"results": [{
+        "ID": 1123,
+        "PackageBaseID": 1122,
+        "Name": "auracle-git",
+        "Description": "skipped, even when \"\u00e9scaped\"",
+        "Depends": ["pacman"],
+        "NumVotes": 29
+      }]})",
+      aur::PackageFields({aur::PackageField::NAME}));
+  ASSERT_TRUE(response.ok()) << response.status();
+  ASSERT_EQ(response->packages.size(), 1);
+
+  const RpcPackageView& package = response->packages[0];
+  EXPECT_EQ(package.package_id, 1123);
+  EXPECT_EQ(package.pkgbase_id, 1122);
+  EXPECT_EQ(package.name, "auracle-git");
+  EXPECT_EQ(package.description, "");
+  EXPECT_THAT(package.depends, IsEmpty());
+  EXPECT_EQ(package.votes, 0);
+}
+
+TEST(ResponseViewTest, ConvertsToPackage) {
+  Package package;
+  {
+    auto response = RpcResponseView::Parse(
+        R"({"results":[{"ID":1,"PackageBaseID":2,"Name":"auracle",)"
+        R"("Version":"1-1","Popularity":1.5,"LastModified":10,)"
+        R"("Depends":["pacman"],"CoMaintainers":["x","y"]}]})");
+    ASSERT_TRUE(response.ok()) << response.status();
+    package = response->packages[0].ToPackage();
+  }
+
+  EXPECT_EQ(package.package_id, 1);
+  EXPECT_EQ(package.pkgbase_id, 2);
+  EXPECT_EQ(package.name, "auracle");
+  EXPECT_EQ(package.version, "1-1");
+  EXPECT_EQ(package.popularity, 1.5);
+  EXPECT_EQ(package.modified, absl::FromUnixSeconds(10));
+  EXPECT_THAT(package.depends, ElementsAre("pacman"));
+  EXPECT_THAT(package.comaintainers, ElementsAre("x", "y"));
+  EXPECT_THAT(package.makedepends, IsEmpty());
+}
+
+TEST(ResponseViewTest, ViewsSurviveMovesAndAppends) {
+  std::vector<Package> packages(2);
+  packages[0].name = "auracle";
+  packages[0].depends = {"pacman", "libcurl.so"};
+  packages[1].name = "pkgfile";
+  packages[1].provides = {"pkgfile-git"};
+
+  auto merged = RpcResponseView::FromPackages(std::move(packages));
+
+  auto parsed = RpcResponseView::Parse(
+      R"({"results":[{"Name":"expac","Depends":["pacman"]}]})");
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  merged.Append(*std::move(parsed));
+
+  RpcResponseView moved = std::move(merged);
+  ASSERT_EQ(moved.packages.size(), 3);
+  EXPECT_EQ(moved.packages[0].name, "auracle");
+  EXPECT_THAT(moved.packages[0].depends, ElementsAre("pacman", "libcurl.so"));
+  EXPECT_EQ(moved.packages[1].name, "pkgfile");
+  EXPECT_THAT(moved.packages[1].provides, ElementsAre("pkgfile-git"));
+  EXPECT_EQ(moved.packages[2].name, "expac");
+  EXPECT_THAT(moved.packages[2].depends, ElementsAre("pacman"));
+}
@@ -0,0 +1,489 @@
+// SPDX-License-Identifier: MIT
+#include "aur/tarball_extractor.hh"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <optional>
+#include <system_error>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+namespace fs = std::filesystem;
+
+namespace aur {
+
+namespace {
+
+constexpr size_t kBlockSize = 512;
+
+// Upper bound on the size of pax headers and GNU long names. These hold a
+// handful of short records, and anything larger isn't worth buffering.
+constexpr uint64_t kMaxMetadataSize = 1 << 20;
+
+// Offsets and sizes of the ustar header fields that we make use of.
+struct Field {
+  size_t offset;
+  size_t size;
+};
+constexpr Field kName = {0, 100};
+constexpr Field kMode = {100, 8};
+constexpr Field kSize = {124, 12};
+constexpr Field kChecksum = {148, 8};
+constexpr size_t kTypeflag = 156;
+constexpr Field kLinkname = {157, 100};
+constexpr Field kMagic = {257, 6};
+constexpr Field kPrefix = {345, 155};
+
+std::string_view StringField(const std::array<char, kBlockSize>& header,
+                             Field field) {
+  const char* begin = header.data() + field.offset;
+  return std::string_view(begin, strnlen(begin, field.size));
+}
+
+// Parses a numeric header field, which is either octal text or, for values too
+// large for that, a GNU-style base-256 number marked by the high bit.
+std::optional<uint64_t> NumericField(const std::array<char, kBlockSize>& header,
+                                     Field field) {
+  const auto* begin =
+      reinterpret_cast<const unsigned char*>(header.data() + field.offset);
+
+  if (begin[0] & 0x80) {
+    if (field.size > sizeof(uint64_t) + 1) {
+      return std::nullopt;
+    }
+
+    uint64_t value = begin[0] & 0x7f;
+    for (size_t i = 1; i < field.size; ++i) {
+      value = (value << 8) | begin[i];
+    }
+    return value;
+  }
+
+  uint64_t value = 0;
+  for (char c : absl::StripAsciiWhitespace(StringField(header, field))) {
+    if (c < '0' || c > '7') {
+      return std::nullopt;
+    }
+    value = value * 8 + (c - '0');
+  }
+  return value;
+}
+
+bool ChecksumMatches(const std::array<char, kBlockSize>& header) {
+  const auto expected = NumericField(header, kChecksum);
+  if (!expected.has_value()) {
+    return false;
+  }
+
+  // The checksum is computed as if its own field were filled with spaces.
+  uint64_t sum = ' ' * kChecksum.size;
+  for (size_t i = 0; i < header.size(); ++i) {
+    if (i < kChecksum.offset || i >= kChecksum.offset + kChecksum.size) {
+      sum += static_cast<unsigned char>(header[i]);
+    }
+  }
+
+  return sum == *expected;
+}
+
+absl::Status FilesystemError(std::string_view action, const fs::path& path,
+                             const std::error_code& ec) {
+  return absl::InternalError(absl::StrCat("failed to ", action, " ",
+                                         path.string(), ": ", ec.message()));
+}
+
+// Clears the way for a new entry at |path|, replacing whatever non-directory
+// is already there.
+absl::Status PrepareEntry(const fs::path& path) {
+  std::error_code ec;
+  fs::create_directories(path.parent_path(), ec);
+  if (ec) {
+    return FilesystemError("create directory", path.parent_path(), ec);
+  }
+
+  const auto status = fs::symlink_status(path, ec);
+  if (fs::exists(status) && !fs::is_directory(status)) {
+    fs::remove(path, ec);
+    if (ec) {
+      return FilesystemError("remove", path, ec);
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+TarballExtractor::TarballExtractor(fs::path directory)
+    : directory_(std::move(directory)) {
+  // 16 + MAX_WBITS tells zlib to expect a gzip header.
+  if (inflateInit2(&zstream_, 16 + MAX_WBITS) != Z_OK) {
+    status_ = absl::InternalError("failed to initialize zlib");
+  }
+}
+
+TarballExtractor::~TarballExtractor() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+
+  inflateEnd(&zstream_);
+}
+
+absl::Status TarballExtractor::Write(std::string_view bytes) {
+  if (!status_.ok()) {
+    return status_;
+  }
+
+  zstream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(bytes.data()));
+  zstream_.avail_in = bytes.size();
+
+  std::array<char, 16384> out;
+  do {
+    if (zstream_end_ && zstream_.avail_in > 0) {
+      // gzip allows for multiple members to be concatenated.
+      inflateReset(&zstream_);
+      zstream_end_ = false;
+    }
+
+    zstream_.next_out = reinterpret_cast<Bytef*>(out.data());
+    zstream_.avail_out = out.size();
+
+    const int r = inflate(&zstream_, Z_NO_FLUSH);
+    if (r == Z_BUF_ERROR) {
+      // No progress was possible without more input.
+      break;
+    }
+    if (r != Z_OK && r != Z_STREAM_END) {
+      return status_ = absl::InvalidArgumentError(absl::StrCat(
+          "decompression error: ",
+          zstream_.msg != nullptr ? zstream_.msg : "invalid data"));
+    }
+    zstream_end_ = r == Z_STREAM_END;
+
+    status_ = Consume(
+        std::string_view(out.data(), out.size() - zstream_.avail_out));
+    if (!status_.ok()) {
+      return status_;
+    }
+  } while (zstream_.avail_in > 0 || zstream_.avail_out == 0);
+
+  return absl::OkStatus();
+}
+
+absl::Status TarballExtractor::Finish() {
+  if (!status_.ok()) {
+    return status_;
+  }
+
+  if (!zstream_end_) {
+    return status_ = absl::DataLossError(
+               "decompression error: truncated input");
+  }
+
+  // Tolerate a missing end of archive marker, as GNU tar does, but not an
+  // entry which was cut short.
+  if (state_ != State::DONE &&
+      (state_ != State::HEADER || header_size_ != 0)) {
+    return status_ = absl::DataLossError("archive is truncated");
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status TarballExtractor::Consume(std::string_view bytes) {
+  while (!bytes.empty()) {
+    switch (state_) {
+      case State::HEADER: {
+        const size_t n = std::min(kBlockSize - header_size_, bytes.size());
+        bytes.copy(header_.data() + header_size_, n);
+        bytes.remove_prefix(n);
+
+        header_size_ += n;
+        if (header_size_ == kBlockSize) {
+          header_size_ = 0;
+          if (auto status = StartEntry(); !status.ok()) {
+            return status;
+          }
+        }
+        break;
+      }
+      case State::FILE_DATA: {
+        const size_t n = std::min<uint64_t>(remaining_, bytes.size());
+        std::string_view data = bytes.substr(0, n);
+        bytes.remove_prefix(n);
+        remaining_ -= n;
+
+        while (!data.empty()) {
+          const ssize_t written = write(fd_, data.data(), data.size());
+          if (written < 0) {
+            if (errno == EINTR) {
+              continue;
+            }
+            return absl::ErrnoToStatus(
+                errno, absl::StrCat("failed to write ", entry_name_));
+          }
+          data.remove_prefix(written);
+        }
+
+        if (remaining_ == 0) {
+          if (auto status = FinishEntry(); !status.ok()) {
+            return status;
+          }
+        }
+        break;
+      }
+      case State::METADATA: {
+        const size_t n = std::min<uint64_t>(remaining_, bytes.size());
+        metadata_.append(bytes.substr(0, n));
+        bytes.remove_prefix(n);
+        remaining_ -= n;
+
+        if (remaining_ == 0) {
+          if (auto status = FinishMetadata(); !status.ok()) {
+            return status;
+          }
+        }
+        break;
+      }
+      case State::PADDING: {
+        const size_t n = std::min<uint64_t>(padding_, bytes.size());
+        bytes.remove_prefix(n);
+
+        padding_ -= n;
+        if (padding_ == 0) {
+          state_ = State::HEADER;
+        }
+        break;
+      }
+      case State::DONE:
+        // Anything following the end of archive marker is padding.
+        return absl::OkStatus();
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status TarballExtractor::StartEntry() {
+  if (std::all_of(header_.begin(), header_.end(),
+                  [](char c) { return c == '\0'; })) {
+    state_ = State::DONE;
+    return absl::OkStatus();
+  }
+
+  const auto size = NumericField(header_, kSize);
+  if (!ChecksumMatches(header_) || !size.has_value()) {
+    return absl::InvalidArgumentError("not a valid tar archive");
+  }
+
+  remaining_ = *size;
+  padding_ = (kBlockSize - *size % kBlockSize) % kBlockSize;
+
+  const char type = header_[kTypeflag];
+  switch (type) {
+    case 'x':  // pax extended header, applying to the next entry
+    case 'L':  // GNU long name
+    case 'K':  // GNU long link name
+      if (*size > kMaxMetadataSize) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("tar header of type '", std::string_view(&type, 1),
+                         "' is too large"));
+      }
+
+      metadata_type_ = type;
+      metadata_.clear();
+      state_ = State::METADATA;
+      return *size == 0 ? FinishMetadata() : absl::OkStatus();
+    case 'g':
+      // A pax global header, e.g. the commit that cgit made a snapshot of.
+      // Nothing in it affects extraction.
+      AdvanceToNextHeader();
+      return absl::OkStatus();
+  }
+
+  if (next_path_.empty()) {
+    entry_name_ = StringField(header_, kName);
+    if (StringField(header_, kMagic).starts_with("ustar")) {
+      if (const auto prefix = StringField(header_, kPrefix); !prefix.empty()) {
+        entry_name_ = absl::StrCat(prefix, "/", entry_name_);
+      }
+    }
+  } else {
+    entry_name_ = std::move(next_path_);
+  }
+
+  std::string linkname = next_linkpath_.empty()
+                             ? std::string(StringField(header_, kLinkname))
+                             : std::move(next_linkpath_);
+  next_path_.clear();
+  next_linkpath_.clear();
+
+  fs::path path;
+  if (auto status = ResolvePath(entry_name_, &path); !status.ok()) {
+    return status;
+  }
+
+  std::error_code ec;
+  switch (type) {
+    case '\0':
+    case '0':
+    case '7': {
+      if (auto status = PrepareEntry(path); !status.ok()) {
+        return status;
+      }
+
+      // Discard any setuid, setgid or sticky bits.
+      const mode_t mode = NumericField(header_, kMode).value_or(0644) & 0777;
+      fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW |
+                                   O_CLOEXEC,
+                 mode);
+      if (fd_ < 0) {
+        return absl::ErrnoToStatus(
+            errno, absl::StrCat("failed to create ", path.string()));
+      }
+
+      state_ = State::FILE_DATA;
+      return *size == 0 ? FinishEntry() : absl::OkStatus();
+    }
+    case '5':
+      fs::create_directories(path, ec);
+      if (ec) {
+        return FilesystemError("create directory", path, ec);
+      }
+      break;
+    case '2':
+      if (auto status = PrepareEntry(path); !status.ok()) {
+        return status;
+      }
+
+      fs::create_symlink(linkname, path, ec);
+      if (ec) {
+        return FilesystemError("create symlink", path, ec);
+      }
+      break;
+    case '1': {
+      fs::path target;
+      if (auto status = ResolvePath(linkname, &target); !status.ok()) {
+        return status;
+      }
+      if (auto status = PrepareEntry(path); !status.ok()) {
+        return status;
+      }
+
+      fs::create_hard_link(target, path, ec);
+      if (ec) {
+        return FilesystemError("create hard link", path, ec);
+      }
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("unsupported tar entry type '",
+                       std::string_view(&type, 1), "' for ", entry_name_));
+  }
+
+  AdvanceToNextHeader();
+  return absl::OkStatus();
+}
+
+absl::Status TarballExtractor::FinishEntry() {
+  const int r = close(fd_);
+  fd_ = -1;
+  if (r < 0) {
+    return absl::ErrnoToStatus(errno,
+                               absl::StrCat("failed to write ", entry_name_));
+  }
+
+  AdvanceToNextHeader();
+  return absl::OkStatus();
+}
+
+absl::Status TarballExtractor::FinishMetadata() {
+  if (metadata_type_ != 'x') {
+    // GNU long names are NUL terminated.
+    std::string name = metadata_.substr(0, metadata_.find('\0'));
+    (metadata_type_ == 'L' ? next_path_ : next_linkpath_) = std::move(name);
+
+    AdvanceToNextHeader();
+    return absl::OkStatus();
+  }
+
+  // pax records take the form "<length> <key>=<value>\n", where the length
+  // counts the entire record.
+  std::string_view records = metadata_;
+  while (!records.empty()) {
+    const auto space = records.find(' ');
+    size_t length;
+    if (space == records.npos ||
+        !absl::SimpleAtoi(records.substr(0, space), &length) ||
+        length <= space + 1 || length > records.size() ||
+        records[length - 1] != '\n') {
+      return absl::InvalidArgumentError("invalid pax header");
+    }
+
+    const auto record = records.substr(space + 1, length - space - 2);
+    records.remove_prefix(length);
+
+    const auto equals = record.find('=');
+    if (equals == record.npos) {
+      return absl::InvalidArgumentError("invalid pax header");
+    }
+
+    const auto key = record.substr(0, equals);
+    if (key == "path") {
+      next_path_ = record.substr(equals + 1);
+    } else if (key == "linkpath") {
+      next_linkpath_ = record.substr(equals + 1);
+    }
+  }
+
+  AdvanceToNextHeader();
+  return absl::OkStatus();
+}
+
+void TarballExtractor::AdvanceToNextHeader() {
+  // Skip over whatever remains of the entry's contents along with its padding.
+  padding_ += remaining_;
+  remaining_ = 0;
+  state_ = padding_ > 0 ? State::PADDING : State::HEADER;
+}
+
+absl::Status TarballExtractor::ResolvePath(std::string_view name,
+                                           fs::path* path) {
+  const fs::path relative = fs::path(name).lexically_normal();
+
+  bool escapes = relative.empty() || relative.is_absolute();
+  for (const auto& component : relative) {
+    escapes |= component == "..";
+  }
+  if (escapes) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "refusing to extract ", name, ": path is outside of the destination"));
+  }
+
+  // Symbolic links in the archive are extracted as-is, so make sure that we
+  // never write through one.
+  fs::path parent = directory_;
+  for (const auto& component : relative.parent_path()) {
+    parent /= component;
+
+    std::error_code ec;
+    if (fs::is_symlink(fs::symlink_status(parent, ec))) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("refusing to extract ", name,
+                       ": path traverses a symbolic link"));
+    }
+  }
+
+  *path = directory_ / relative;
+  return absl::OkStatus();
+}
+
+}  // namespace aur
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: MIT
+#ifndef AUR_TARBALL_EXTRACTOR_HH_
+#define AUR_TARBALL_EXTRACTOR_HH_
+
+#include <zlib.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+
+namespace aur {
+
+// TarballExtractor unpacks a gzip compressed tar archive, such as a snapshot of
+// a package's sources, as its bytes arrive. Nothing is buffered beyond the tar
+// header currently being read, so archives can be extracted straight off the
+// wire.
+//
+// Regular files, directories, symbolic and hard links are supported, along with
+// the pax and GNU extensions for long names. Entries which would be written
+// outside of the destination directory, either directly or through a symbolic
+// link, are rejected.
+class TarballExtractor {
+ public:
+  explicit TarballExtractor(std::filesystem::path directory);
+  ~TarballExtractor();
+
+  TarballExtractor(const TarballExtractor&) = delete;
+  TarballExtractor& operator=(const TarballExtractor&) = delete;
+
+  TarballExtractor(TarballExtractor&&) = delete;
+  TarballExtractor& operator=(TarballExtractor&&) = delete;
+
+  // Decompresses and extracts the next chunk of the archive. Once an error is
+  // returned, the extractor refuses any further input.
+  absl::Status Write(std::string_view bytes);
+
+  // Checks that the archive was complete. Must be called after the last Write.
+  absl::Status Finish();
+
+ private:
+  enum class State {
+    // Reading a 512 byte header block.
+    HEADER,
+    // Writing the contents of a regular file.
+    FILE_DATA,
+    // Collecting the contents of a pax header or GNU long name.
+    METADATA,
+    // Skipping over the padding which follows an entry's contents.
+    PADDING,
+    // An end of archive marker was seen.
+    DONE,
+  };
+
+  absl::Status Consume(std::string_view bytes);
+  absl::Status StartEntry();
+  absl::Status FinishEntry();
+  absl::Status FinishMetadata();
+  void AdvanceToNextHeader();
+
+  // Maps an archive member's name onto a path within the destination
+  // directory.
+  absl::Status ResolvePath(std::string_view name, std::filesystem::path* path);
+
+  const std::filesystem::path directory_;
+  absl::Status status_;
+
+  z_stream zstream_ = {};
+  bool zstream_end_ = false;
+
+  State state_ = State::HEADER;
+  std::array<char, 512> header_;
+  size_t header_size_ = 0;
+
+  // Remaining bytes of the current entry's contents and padding.
+  uint64_t remaining_ = 0;
+  uint64_t padding_ = 0;
+
+  // The name of the current entry, the file being written for it, and the
+  // kind of metadata being collected.
+  std::string entry_name_;
+  int fd_ = -1;
+  char metadata_type_ = 0;
+  std::string metadata_;
+
+  // Overrides for the next entry, from a pax header or GNU long name.
+  std::string next_path_;
+  std::string next_linkpath_;
+};
+
+}  // namespace aur
+
+#endif  // AUR_TARBALL_EXTRACTOR_HH_
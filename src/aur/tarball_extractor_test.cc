@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: MIT
+#include "aur/tarball_extractor.hh"
+
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace fs = std::filesystem;
+
+using aur::TarballExtractor;
+using testing::HasSubstr;
+
+namespace {
+
+// Builds a ustar archive in memory.
+class TarBuilder {
+ public:
+  TarBuilder& AddFile(std::string_view name, std::string_view contents,
+                      int mode = 0644) {
+    return AddEntry(name, '0', contents, mode);
+  }
+
+  TarBuilder& AddDirectory(std::string_view name) {
+    return AddEntry(name, '5', "", 0755);
+  }
+
+  TarBuilder& AddSymlink(std::string_view name, std::string_view target) {
+    return AddEntry(name, '2', "", 0777, target);
+  }
+
+  TarBuilder& AddPaxHeader(std::string_view key, std::string_view value) {
+    // The length of a record includes the digits of the length itself.
+    const std::string record = absl::StrCat(" ", key, "=", value, "\n");
+    size_t length = record.size() + 1;
+    while (absl::StrCat(length).size() + record.size() != length) {
+      ++length;
+    }
+
+    return AddEntry("PaxHeader", 'x', absl::StrCat(length, record), 0644);
+  }
+
+  TarBuilder& AddEntry(std::string_view name, char type,
+                       std::string_view contents, int mode,
+                       std::string_view linkname = "") {
+    std::string header(512, '\0');
+    name.copy(header.data(), std::min<size_t>(name.size(), 100));
+    absl::SNPrintF(&header[100], 8, "%07o", mode);
+    absl::SNPrintF(&header[108], 8, "%07o", 0);
+    absl::SNPrintF(&header[116], 8, "%07o", 0);
+    absl::SNPrintF(&header[124], 12, "%011o", contents.size());
+    absl::SNPrintF(&header[136], 12, "%011o", 0);
+    header[156] = type;
+    linkname.copy(&header[157], std::min<size_t>(linkname.size(), 100));
+    std::string_view("ustar\0" "00", 8).copy(&header[257], 8);
+
+    header.replace(148, 8, 8, ' ');
+    unsigned sum = 0;
+    for (unsigned char c : header) {
+      sum += c;
+    }
+    absl::SNPrintF(&header[148], 8, "%06o", sum);
+
+    absl::StrAppend(&archive_, header, contents,
+                    std::string((512 - contents.size() % 512) % 512, '\0'));
+    return *this;
+  }
+
+  std::string Build() const {
+    return absl::StrCat(archive_, std::string(1024, '\0'));
+  }
+
+ private:
+  std::string archive_;
+};
+
+std::string Gzip(std::string_view bytes) {
+  z_stream stream{};
+  deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+               Z_DEFAULT_STRATEGY);
+
+  std::string out(deflateBound(&stream, bytes.size()), '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(bytes.data()));
+  stream.avail_in = bytes.size();
+  stream.next_out = reinterpret_cast<Bytef*>(out.data());
+  stream.avail_out = out.size();
+
+  deflate(&stream, Z_FINISH);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+
+  return out;
+}
+
+std::string ReadFile(const fs::path& path) {
+  std::ifstream file(path);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+}  // namespace
+
+class TarballExtractorTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = fs::path(testing::TempDir()) /
+                 testing::UnitTest::GetInstance()->current_test_info()->name();
+    fs::remove_all(directory_);
+    fs::create_directories(directory_);
+  }
+
+  void TearDown() override { fs::remove_all(directory_); }
+
+  absl::Status Extract(std::string_view tarball) {
+    TarballExtractor extractor(directory_);
+    if (auto status = extractor.Write(tarball); !status.ok()) {
+      return status;
+    }
+    return extractor.Finish();
+  }
+
+  fs::path directory_;
+};
+
+TEST_F(TarballExtractorTest, ExtractsFilesAndDirectories) {
+  const auto tarball = Gzip(TarBuilder()
+                                .AddDirectory("auracle-git/")
+                                .AddFile("auracle-git/PKGBUILD", "pkgname=x\n")
+                                .AddFile("auracle-git/build.sh", "#!/bin/sh\n",
+                                         0755)
+                                .AddFile("auracle-git/empty", "")
+                                .Build());
+
+  auto status = Extract(tarball);
+  ASSERT_TRUE(status.ok()) << status;
+
+  EXPECT_EQ(ReadFile(directory_ / "auracle-git/PKGBUILD"), "pkgname=x\n");
+  EXPECT_EQ(ReadFile(directory_ / "auracle-git/empty"), "");
+
+  struct stat st;
+  ASSERT_EQ(stat((directory_ / "auracle-git/build.sh").c_str(), &st), 0);
+  EXPECT_TRUE(st.st_mode & S_IXUSR);
+}
+
+TEST_F(TarballExtractorTest, ExtractsInArbitraryChunks) {
+  const std::string contents(100000, 'x');
+  const auto tarball = Gzip(TarBuilder()
+                                .AddFile("pkg/PKGBUILD", "pkgname=pkg\n")
+                                .AddFile("pkg/large", contents)
+                                .Build());
+
+  TarballExtractor extractor(directory_);
+  for (char c : tarball) {
+    auto status = extractor.Write(std::string_view(&c, 1));
+    ASSERT_TRUE(status.ok()) << status;
+  }
+  auto status = extractor.Finish();
+  ASSERT_TRUE(status.ok()) << status;
+
+  EXPECT_EQ(ReadFile(directory_ / "pkg/PKGBUILD"), "pkgname=pkg\n");
+  EXPECT_EQ(ReadFile(directory_ / "pkg/large"), contents);
+}
+
+TEST_F(TarballExtractorTest, HonorsPaxPaths) {
+  const std::string name = absl::StrCat("pkg/", std::string(150, 'a'));
+  const auto tarball = Gzip(TarBuilder()
+                                .AddPaxHeader("path", name)
+                                .AddFile("truncated", "contents")
+                                .Build());
+
+  auto status = Extract(tarball);
+  ASSERT_TRUE(status.ok()) << status;
+
+  EXPECT_EQ(ReadFile(directory_ / name), "contents");
+  EXPECT_FALSE(fs::exists(directory_ / "truncated"));
+}
+
+TEST_F(TarballExtractorTest, RejectsPathsOutsideOfDestination) {
+  for (const auto* name : {"../escape", "/tmp/escape", "pkg/../../escape"}) {
+    auto status = Extract(Gzip(TarBuilder().AddFile(name, "x").Build()));
+    EXPECT_TRUE(absl::IsInvalidArgument(status)) << name << ": " << status;
+  }
+
+  EXPECT_FALSE(fs::exists(directory_.parent_path() / "escape"));
+}
+
+TEST_F(TarballExtractorTest, RejectsWritesThroughSymlinks) {
+  const auto tarball = Gzip(TarBuilder()
+                                .AddSymlink("pkg/link", "/tmp")
+                                .AddFile("pkg/link/escape", "x")
+                                .Build());
+
+  auto status = Extract(tarball);
+  EXPECT_TRUE(absl::IsInvalidArgument(status)) << status;
+  EXPECT_THAT(status.message(), HasSubstr("symbolic link"));
+  EXPECT_TRUE(fs::is_symlink(directory_ / "pkg/link"));
+}
+
+TEST_F(TarballExtractorTest, RejectsInvalidInput) {
+  auto status = Extract("you should use a better AUR helper");
+  EXPECT_TRUE(absl::IsInvalidArgument(status)) << status;
+
+  status = Extract(Gzip("this is not a tarball"));
+  EXPECT_FALSE(status.ok());
+}
+
+TEST_F(TarballExtractorTest, RejectsTruncatedInput) {
+  const auto tarball = Gzip(
+      TarBuilder().AddFile("pkg/PKGBUILD", std::string(4096, 'x')).Build());
+
+  auto status = Extract(tarball.substr(0, tarball.size() / 2));
+  EXPECT_TRUE(absl::IsDataLoss(status)) << status;
+
+  // A complete gzip stream holding an incomplete archive.
+  status = Extract(Gzip(
+      TarBuilder().AddFile("pkg/PKGBUILD", "pkgname=pkg\n").Build().substr(
+          0, 600)));
+  EXPECT_TRUE(absl::IsDataLoss(status)) << status;
+}
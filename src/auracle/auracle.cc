@@ -3,17 +3,27 @@
 
 #include <cerrno>
 #include <filesystem>
+#include <fstream>
 #include <functional>
+#include <iterator>
+#include <optional>
 #include <print>
 #include <regex>
 #include <string_view>
 #include <tuple>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "aur/metadata_index.hh"
 #include "aur/response.hh"
+#include "aur/response_view.hh"
 #include "auracle/dependency.hh"
+#include "auracle/dependency_graph.hh"
 #include "auracle/format.hh"
 #include "auracle/pacman.hh"
 #include "auracle/search_fragment.hh"
@@ -86,28 +96,185 @@ void FormatLong(const std::vector<aur::Package>& packages,
   }
 }
 
-void FormatNameOnly(const std::vector<aur::Package>& packages) {
+template <typename PackageT>
+void FormatNameOnly(const std::vector<PackageT>& packages) {
   for (const auto& p : packages) {
     format::NameOnly(p);
   }
 }
 
-void FormatShort(const std::vector<aur::Package>& packages,
+template <typename PackageT>
+void FormatShort(const std::vector<PackageT>& packages,
                  const auracle::Pacman* pacman) {
   for (const auto& p : packages) {
-    format::Short(p, pacman->GetLocalPackage(p.name));
+    format::Short(p, pacman->GetLocalPackage(std::string(p.name)));
   }
 }
 
-void FormatCustom(const std::vector<aur::Package>& packages,
+template <typename PackageT>
+void FormatCustom(const std::vector<PackageT>& packages,
                   const std::string& format) {
   for (const auto& p : packages) {
     format::Custom(format, p);
   }
 }
 
-void SortUnique(std::vector<aur::Package>& packages,
-                const sort::Sorter& sorter) {
+void FormatBuildWaves(const DependencyGraph& graph,
+                      const DependencyGraph::Schedule* schedule) {
+  const auto& nodes = graph.nodes();
+  const auto waves = graph.Waves();
+  for (size_t i = 0; i < waves.size(); ++i) {
+    for (size_t j = 0; j < waves[i].size(); ++j) {
+      const int idx = waves[i][j];
+      const auto& node = nodes[idx];
+
+      // The members of a cycle are adjacent, and announced by the first.
+      if (node.cycle != -1 &&
+          (j == 0 || nodes[waves[i][j - 1]].cycle != node.cycle)) {
+        std::vector<std::string_view> members;
+        for (size_t k = j;
+             k < waves[i].size() && nodes[waves[i][k]].cycle == node.cycle;
+             ++k) {
+          members.push_back(nodes[waves[i][k]].pkgbase);
+        }
+        std::println("CYCLE {}", absl::StrJoin(members, " "));
+      }
+
+      std::print("{} {}", i, node.pkgbase);
+      if (schedule != nullptr) {
+        std::print(" {} {}", schedule->earliest_start[idx],
+                   schedule->slack[idx]);
+      }
+      for (const auto* package : node.packages) {
+        std::print(" {}", package->name);
+      }
+      std::println("");
+    }
+  }
+
+  if (schedule != nullptr) {
+    std::print("CRITICAL {}", schedule->makespan);
+    for (const int idx : schedule->critical_path) {
+      std::print(" {}", nodes[idx].pkgbase);
+    }
+    std::println("");
+  }
+}
+
+// Package names and pkgbases are restricted to characters that never need
+// escaping in JSON.
+void FormatBuildWavesJson(const DependencyGraph& graph,
+                          const std::vector<double>* costs,
+                          const DependencyGraph::Schedule* schedule) {
+  const auto& nodes = graph.nodes();
+
+  std::vector<int> wave_of(nodes.size());
+  const auto waves = graph.Waves();
+  for (size_t i = 0; i < waves.size(); ++i) {
+    for (const int idx : waves[i]) {
+      wave_of[idx] = i;
+    }
+  }
+
+  const auto quoted = [](std::string* out, std::string_view s) {
+    absl::StrAppend(out, "\"", s, "\"");
+  };
+
+  std::vector<std::string> objects;
+  objects.reserve(nodes.size());
+  for (size_t idx = 0; idx < nodes.size(); ++idx) {
+    const auto& node = nodes[idx];
+    std::string object = absl::StrFormat(
+        R"({"pkgbase":"%s","pkgnames":[%s],"wave":%d,"depends":[%s])",
+        node.pkgbase,
+        absl::StrJoin(node.packages, ",",
+                      [&](std::string* out, const aur::Package* package) {
+                        quoted(out, package->name);
+                      }),
+        wave_of[idx],
+        absl::StrJoin(node.depends, ",", [&](std::string* out, int dep) {
+          quoted(out, nodes[dep].pkgbase);
+        }));
+    if (node.cycle != -1) {
+      absl::StrAppendFormat(&object, R"(,"cycle":%d)", node.cycle);
+    }
+    if (schedule != nullptr) {
+      absl::StrAppendFormat(&object,
+                            R"(,"cost":%g,"earliest_start":%g,"slack":%g)",
+                            (*costs)[idx], schedule->earliest_start[idx],
+                            schedule->slack[idx]);
+    }
+    objects.push_back(absl::StrCat(object, "}"));
+  }
+
+  std::string out = absl::StrCat(R"({"nodes":[)", absl::StrJoin(objects, ","),
+                                 "]");
+  if (schedule != nullptr) {
+    absl::StrAppendFormat(
+        &out, R"(,"makespan":%g,"critical_path":[%s])", schedule->makespan,
+        absl::StrJoin(schedule->critical_path, ",",
+                      [&](std::string* out, int idx) {
+                        quoted(out, nodes[idx].pkgbase);
+                      }));
+  }
+  std::println("{}}}", out);
+}
+
+// Reads the build costs in |path|, which must be a file as understood by
+// ParseBuildCosts.
+absl::StatusOr<absl::flat_hash_map<std::string, double>> ReadBuildCosts(
+    const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return absl::NotFoundError(absl::StrCat("failed to open ", path));
+  }
+
+  return ParseBuildCosts(std::string(std::istreambuf_iterator<char>(file),
+                                     std::istreambuf_iterator<char>()));
+}
+
+// Returns the cost of building each node of |graph|. Those pkgbases without a
+// known cost are assumed to take the average of the known costs.
+std::vector<double> BuildCostsForGraph(
+    const DependencyGraph& graph,
+    const absl::flat_hash_map<std::string, double>& build_costs) {
+  double average = 0;
+  for (const auto& [_, seconds] : build_costs) {
+    average += seconds / build_costs.size();
+  }
+
+  std::vector<double> costs;
+  costs.reserve(graph.nodes().size());
+  for (const auto& node : graph.nodes()) {
+    const auto iter = build_costs.find(node.pkgbase);
+    costs.push_back(iter == build_costs.end() ? average : iter->second);
+  }
+  return costs;
+}
+
+SearchBy SearchByForDependencyKind(DependencyKind kind) {
+  switch (kind) {
+    case DependencyKind::Depend:
+      return SearchBy::DEPENDS;
+    case DependencyKind::MakeDepend:
+      return SearchBy::MAKEDEPENDS;
+    case DependencyKind::CheckDepend:
+      return SearchBy::CHECKDEPENDS;
+  }
+
+  return SearchBy::INVALID;
+}
+
+aur::CloneRequest MakeCloneRequest(std::string pkgbase,
+                                   const Auracle::CommandOptions& options) {
+  aur::CloneRequest request(std::move(pkgbase));
+  request.set_depth(options.clone_depth);
+  request.set_filter(options.clone_filter);
+  return request;
+}
+
+template <typename PackageT, typename SorterT>
+void SortUnique(std::vector<PackageT>& packages, const SorterT& sorter) {
   absl::c_sort(packages, sorter);
   packages.resize(std::unique(packages.begin(), packages.end()) -
                   packages.begin());
@@ -151,7 +318,54 @@ bool ChdirIfNeeded(const fs::path& target) {
   return true;
 }
 
-bool RpcResponseIsFailure(const absl::StatusOr<aur::RpcResponse>& response) {
+aur::Client::Options MakeClientOptions(const Auracle::Options& options) {
+  auto client_options = aur::Client::Options()
+                            .set_baseurl(options.baseurl)
+                            .set_proxy(options.proxy)
+                            .set_useragent("Auracle/" PROJECT_VERSION)
+                            .set_cache_directory(options.cache_directory)
+                            .set_stats(options.stats);
+
+  if (options.cache_ttl.has_value()) {
+    client_options.set_cache_ttl("/rpc/v5/info", *options.cache_ttl)
+        .set_cache_ttl("/rpc/v5/search", *options.cache_ttl);
+  }
+
+  if (options.max_parallel_clones.has_value()) {
+    client_options.set_max_parallel_clones(*options.max_parallel_clones);
+  }
+
+  if (options.max_requests_per_second.has_value()) {
+    client_options.set_max_requests_per_second(
+        *options.max_requests_per_second);
+  }
+
+  if (options.max_connections.has_value()) {
+    client_options.set_max_connections(*options.max_connections);
+  }
+
+  if (options.max_streams_per_connection.has_value()) {
+    client_options.set_max_streams_per_connection(
+        *options.max_streams_per_connection);
+  }
+
+  if (options.connect_timeout.has_value()) {
+    client_options.set_connect_timeout(*options.connect_timeout);
+  }
+
+  if (options.keepalive.has_value()) {
+    client_options.set_keepalive(*options.keepalive);
+  }
+
+  if (options.offline) {
+    client_options.set_offline_index(options.metadata_file);
+  }
+
+  return client_options;
+}
+
+template <typename ResponseT>
+bool RpcResponseIsFailure(const absl::StatusOr<ResponseT>& response) {
   if (response.ok()) {
     return false;
   }
@@ -163,11 +377,9 @@ bool RpcResponseIsFailure(const absl::StatusOr<aur::RpcResponse>& response) {
 }  // namespace
 
 Auracle::Auracle(Options options)
-    : client_(aur::Client::New(aur::Client::Options()
-                                   .set_baseurl(options.baseurl)
-                                   .set_proxy(options.proxy)
-                                   .set_useragent("Auracle/" PROJECT_VERSION))),
-      pacman_(options.pacman) {}
+    : client_(aur::Client::New(MakeClientOptions(options))),
+      pacman_(options.pacman),
+      metadata_file_(std::move(options.metadata_file)) {}
 
 void Auracle::ResolveMany(const std::vector<std::string>& depstrings,
                           aur::Client::RpcResponseCallback callback) {
@@ -212,18 +424,22 @@ void Auracle::ResolveMany(const std::vector<std::string>& depstrings,
         return 0;
       });
 
+  // Only the names of the candidates are needed, to ask for their details.
   for (const auto& depstring : depstrings) {
-    client_->QueueRpcRequest(
-        aur::SearchRequest(SearchBy::PROVIDES,
-                           deps->emplace_back(depstring).name()),
-        merger->callback());
+    aur::SearchRequest request(SearchBy::PROVIDES,
+                               deps->emplace_back(depstring).name());
+    request.set_fields({aur::PackageField::NAME});
+
+    client_->QueueRpcRequest(request, merger->callback());
   }
 }
 
 void Auracle::IteratePackages(std::vector<std::string> args,
                               Auracle::PackageIterator* state) {
+  // Each name is asked for at most once, whether or not the AUR knows of it.
   std::erase_if(args, [&](const std::string& arg) {
-    return state->package_cache.LookupByPkgname(arg) != nullptr;
+    return state->package_cache.LookupByPkgname(arg) != nullptr ||
+           !state->requested.insert(arg).second;
   });
   if (args.empty()) {
     return;
@@ -246,14 +462,18 @@ void Auracle::IteratePackages(std::vector<std::string> args,
           }
         }
 
-        for (auto& result : results) {
-          // check for the pkgbase existing in our repo
-          const bool have_pkgbase =
-              state->package_cache.LookupByPkgbase(result.pkgbase) != nullptr;
+        // The dependencies of every package in this response make up the next
+        // level of the walk, which is fetched with a single request.
+        std::vector<std::string> next_level;
 
-          // Regardless, try to add the package, as it might be another member
-          // of the same pkgbase.
-          auto [p, added] = state->package_cache.AddPackage(std::move(result));
+        // Add every package, even those of a pkgbase we already have, as they
+        // might be other members of the same pkgbase.
+        for (auto [p, added] :
+             state->package_cache.AddPackages(std::move(results))) {
+          // The pkgbase is indexed by its first member, so any other package
+          // means that the pkgbase was already in our repo.
+          const bool have_pkgbase =
+              state->package_cache.LookupByPkgbase(p->pkgbase) != p;
 
           if (!added || have_pkgbase) {
             continue;
@@ -264,28 +484,52 @@ void Auracle::IteratePackages(std::vector<std::string> args,
           }
 
           if (state->recurse) {
-            std::vector<std::string> alldeps;
-            alldeps.reserve(p->depends.size() + p->makedepends.size() +
-                            p->checkdepends.size());
-
             for (auto kind : state->resolve_depends) {
               for (const auto& dep : GetDependenciesByKind(p, kind)) {
-                alldeps.push_back(Dependency(dep).name());
+                next_level.push_back(Dependency(dep).name());
               }
             }
-
-            if (alldeps.empty()) {
-              continue;
-            }
-
-            IteratePackages(std::move(alldeps), state);
           }
         }
 
+        IteratePackages(std::move(next_level), state);
+
         return 0;
       });
 }
 
+void Auracle::IterateDependents(const std::string& name,
+                                DependentIterator* state) {
+  if (!state->queried.insert(name).second) {
+    return;
+  }
+
+  for (auto kind : state->resolve_depends) {
+    client_->QueueRpcRequest(
+        aur::SearchRequest(SearchByForDependencyKind(kind), name),
+        [this, state](absl::StatusOr<aur::RpcResponse> response) {
+          if (RpcResponseIsFailure(response)) {
+            return -EIO;
+          }
+
+          for (auto& result : response.value().packages) {
+            if (state->recurse) {
+              // Dependents may be depended on by name, or by anything that
+              // they provide.
+              IterateDependents(result.name, state);
+              for (const auto& provide : result.provides) {
+                IterateDependents(Dependency(provide).name(), state);
+              }
+            }
+
+            state->dependents.push_back(std::move(result));
+          }
+
+          return 0;
+        });
+  }
+}
+
 int Auracle::Info(const std::vector<std::string>& args,
                   const CommandOptions& options) {
   if (args.empty()) {
@@ -378,14 +622,17 @@ int Auracle::Search(const std::vector<std::string>& args,
     }
   }
 
-  const auto matches = [&](const aur::Package& p) {
+  const auto search = [](std::string_view s, const std::regex& re) {
+    return std::regex_search(s.begin(), s.end(), re);
+  };
+
+  const auto matches = [&](const aur::RpcPackageView& p) {
     return absl::c_all_of(patterns, [&](const std::regex& re) {
       switch (options.search_by) {
         case SearchBy::NAME:
-          return std::regex_search(p.name, re);
+          return search(p.name, re);
         case SearchBy::NAME_DESC:
-          return std::regex_search(p.name, re) ||
-                 std::regex_search(p.description, re);
+          return search(p.name, re) || search(p.description, re);
         default:
           // The AUR only matches maintainer and *depends
           // fields exactly so there's no point in doing
@@ -402,7 +649,22 @@ int Auracle::Search(const std::vector<std::string>& args,
       options.allow_regex && (options.search_by == SearchBy::NAME ||
                               options.search_by == SearchBy::NAME_DESC);
 
-  std::vector<aur::Package> packages;
+  // Search results can be large, and most of what's in them is either
+  // filtered out or only printed, so they're never copied out of the
+  // responses. Unless a custom format might ask for anything at all, only what
+  // is matched on, sorted on and printed is decoded.
+  aur::PackageFields fields = aur::PackageFields::All();
+  if (options.format.empty()) {
+    fields = {aur::PackageField::NAME, aur::PackageField::DESCRIPTION,
+              aur::PackageField::VOTES, aur::PackageField::POPULARITY,
+              aur::PackageField::SUBMITTED, aur::PackageField::MODIFIED};
+    if (!options.quiet) {
+      fields.Add(aur::PackageField::VERSION)
+          .Add(aur::PackageField::OUT_OF_DATE);
+    }
+  }
+
+  aur::RpcResponseView results;
   for (const auto& arg : args) {
     std::string_view frag = arg;
     if (allow_regex) {
@@ -416,19 +678,19 @@ int Auracle::Search(const std::vector<std::string>& args,
       }
     }
 
-    client_->QueueRpcRequest(aur::SearchRequest(options.search_by, frag),
-                             [&](absl::StatusOr<aur::RpcResponse> response) {
-                               if (RpcResponseIsFailure(response)) {
-                                 return -EIO;
-                               }
+    aur::SearchRequest request(options.search_by, frag);
+    request.set_fields(fields);
 
-                               auto& results = response.value().packages;
-                               std::copy_if(
-                                   std::make_move_iterator(results.begin()),
-                                   std::make_move_iterator(results.end()),
-                                   std::back_inserter(packages), matches);
-                               return 0;
-                             });
+    client_->QueueRpcViewRequest(
+        request, [&](absl::StatusOr<aur::RpcResponseView> response) {
+          if (RpcResponseIsFailure(response)) {
+            return -EIO;
+          }
+
+          std::erase_if(response->packages, std::not_fn(matches));
+          results.Append(*std::move(response));
+          return 0;
+        });
   }
 
   int r = client_->Wait();
@@ -436,7 +698,8 @@ int Auracle::Search(const std::vector<std::string>& args,
     return r;
   }
 
-  SortUnique(packages, options.sorter);
+  auto& packages = results.packages;
+  SortUnique(packages, options.view_sorter);
 
   if (!options.format.empty()) {
     FormatCustom(packages, options.format);
@@ -462,21 +725,8 @@ int Auracle::Clone(const std::vector<std::string>& args,
   int ret = 0;
   PackageIterator iter(
       options.recurse, options.resolve_depends,
-      [this, &ret](const aur::Package& p) {
-        client_->QueueCloneRequest(
-            aur::CloneRequest(p.pkgbase),
-            [&ret,
-             pkgbase = p.pkgbase](absl::StatusOr<aur::CloneResponse> response) {
-              if (response.ok()) {
-                std::println("{} complete: {}", response.value().operation,
-                             (fs::current_path() / pkgbase).string());
-              } else {
-                std::println(stderr, "error: clone failed for {}: {}", pkgbase,
-                             response.status().ToString());
-                ret = -EIO;
-              }
-              return 0;
-            });
+      [this, &ret, &options](const aur::Package& p) {
+        QueueSourceDownload(p, options, &ret);
       });
 
   IteratePackages(args, &iter);
@@ -493,6 +743,30 @@ int Auracle::Clone(const std::vector<std::string>& args,
   return ret;
 }
 
+void Auracle::QueueSourceDownload(const aur::Package& package,
+                                  const CommandOptions& options, int* ret) {
+  auto callback = [ret, pkgbase = package.pkgbase](
+                      absl::StatusOr<aur::CloneResponse> response) {
+    if (response.ok()) {
+      std::println("{} complete: {}", response.value().operation,
+                   (fs::current_path() / pkgbase).string());
+    } else {
+      std::println(stderr, "error: clone failed for {}: {}", pkgbase,
+                   response.status().ToString());
+      *ret = -EIO;
+    }
+    return 0;
+  };
+
+  if (options.snapshot) {
+    client_->QueueSnapshotRequest(aur::RawRequest::ForSnapshot(package),
+                                  std::move(callback));
+  } else {
+    client_->QueueCloneRequest(MakeCloneRequest(package.pkgbase, options),
+                               std::move(callback));
+  }
+}
+
 int Auracle::Show(const std::vector<std::string>& args,
                   const CommandOptions& options) {
   if (args.empty()) {
@@ -527,7 +801,7 @@ int Auracle::Show(const std::vector<std::string>& args,
                 if (print_header) {
                   std::println("### BEGIN {}/{}", pkgbase, options.show_file);
                 }
-                std::println("{}", response.value().bytes);
+                response.value().WriteTo(stdout);
                 return 0;
               });
         }
@@ -552,6 +826,17 @@ int Auracle::BuildOrder(const std::vector<std::string>& args,
     return ErrorNotEnoughArgs();
   }
 
+  std::optional<absl::flat_hash_map<std::string, double>> build_costs;
+  if (!options.build_costs_file.empty()) {
+    auto costs = ReadBuildCosts(options.build_costs_file);
+    if (!costs.ok()) {
+      std::println(stderr, "error: failed to read build costs: {}",
+                   costs.status().message());
+      return -EINVAL;
+    }
+    build_costs = std::move(costs).value();
+  }
+
   PackageIterator iter(/* recurse = */ true, options.resolve_depends, nullptr);
   IteratePackages(args, &iter);
 
@@ -580,42 +865,110 @@ int Auracle::BuildOrder(const std::vector<std::string>& args,
         options.resolve_depends);
   }
 
+  // Packages which depend on each other can't be ordered, so each set of them
+  // is built as a single unit, at the position of its last member.
+  const auto cycles =
+      iter.package_cache.FindDependencyCycles(args, options.resolve_depends);
+  absl::flat_hash_map<const aur::Package*, int> cycle_by_package;
+  for (int i = 0; i < static_cast<int>(cycles.size()); ++i) {
+    std::vector<std::string_view> names;
+    for (const auto* package : cycles[i]) {
+      cycle_by_package.emplace(package, i);
+      names.push_back(package->name);
+    }
+    std::println(stderr, "warning: found dependency cycle: {}",
+                 absl::StrJoin(names, " "));
+  }
+
+  if (options.build_waves != CommandOptions::BuildWaves::NONE ||
+      build_costs.has_value()) {
+    // Only packages from the AUR need building. Anything else either comes
+    // from the repos, or can't be found at all.
+    std::vector<const aur::Package*> packages;
+    for (const auto& [name, pkg, dependency_path] : total_ordering) {
+      if (pkg != nullptr) {
+        packages.push_back(pkg);
+      } else if (!pacman_->HasPackage(name)) {
+        std::println(stderr, "error: unknown dependency: {}",
+                     absl::StrJoin(dependency_path, " -> "));
+        r = -ENXIO;
+      }
+    }
+
+    const DependencyGraph graph(iter.package_cache, packages,
+                                options.resolve_depends);
+
+    std::vector<double> costs;
+    std::optional<DependencyGraph::Schedule> schedule;
+    if (build_costs.has_value()) {
+      costs = BuildCostsForGraph(graph, *build_costs);
+      schedule = graph.ComputeSchedule(costs);
+    }
+
+    const auto* schedule_ptr = schedule ? &*schedule : nullptr;
+    if (options.build_waves == CommandOptions::BuildWaves::JSON) {
+      FormatBuildWavesJson(graph, &costs, schedule_ptr);
+    } else {
+      FormatBuildWaves(graph, schedule_ptr);
+    }
+
+    return r;
+  }
+
+  struct PendingCycle {
+    std::vector<std::string_view> names;
+    std::vector<std::string> lines;
+  };
+  std::vector<PendingCycle> pending_cycles(cycles.size());
+
   for (const auto& [name, pkg, dependency_path] : total_ordering) {
     const bool satisfied = pacman_->DependencyIsSatisfied(name);
     const bool from_aur = pkg != nullptr;
     const bool unknown = !from_aur && !pacman_->HasPackage(name);
     const bool is_target = absl::c_find(args, name) != args.end();
 
+    std::string line;
     if (unknown) {
-      std::print("UNKNOWN");
+      line = "UNKNOWN";
       r = -ENXIO;
     } else {
       if (is_target) {
-        std::print("TARGET");
+        line = "TARGET";
       } else if (satisfied) {
-        std::print("SATISFIED");
+        line = "SATISFIED";
       }
 
-      if (from_aur) {
-        std::print("AUR");
-      } else {
-        std::print("REPOS");
-      }
+      absl::StrAppend(&line, from_aur ? "AUR" : "REPOS");
     }
 
     if (unknown) {
       for (auto iter = dependency_path.crbegin();
            iter != dependency_path.crend(); ++iter) {
-        std::print(" {}", *iter);
+        absl::StrAppend(&line, " ", *iter);
       }
     } else {
-      std::print(" {}", name);
+      absl::StrAppend(&line, " ", name);
       if (from_aur) {
-        std::print(" {}", pkg->pkgbase);
+        absl::StrAppend(&line, " ", pkg->pkgbase);
       }
     }
 
-    std::println("");
+    const auto cycle = from_aur ? cycle_by_package.find(pkg)
+                                : cycle_by_package.end();
+    if (cycle == cycle_by_package.end()) {
+      std::println("{}", line);
+      continue;
+    }
+
+    auto& pending = pending_cycles[cycle->second];
+    pending.names.push_back(name);
+    pending.lines.push_back(std::move(line));
+    if (pending.lines.size() == cycles[cycle->second].size()) {
+      std::println("CYCLE {}", absl::StrJoin(pending.names, " "));
+      for (const auto& member : pending.lines) {
+        std::println("{}", member);
+      }
+    }
   }
 
   return r;
@@ -640,20 +993,7 @@ int Auracle::Update(const std::vector<std::string>& args,
   int ret = 0;
   PackageIterator iter(
       options.recurse, options.resolve_depends, [&](const aur::Package& p) {
-        client_->QueueCloneRequest(
-            aur::CloneRequest(p.pkgbase),
-            [&ret,
-             pkgbase = p.pkgbase](absl::StatusOr<aur::CloneResponse> response) {
-              if (response.ok()) {
-                std::println("{} complete: {}", response.value().operation,
-                             (fs::current_path() / pkgbase).string());
-              } else {
-                std::println(stderr, "error: clone failed for {}: {}", pkgbase,
-                             response.status().ToString());
-                ret = -EIO;
-              }
-              return 0;
-            });
+        QueueSourceDownload(p, options, &ret);
       });
 
   std::vector<std::string> outdated;
@@ -670,7 +1010,10 @@ int Auracle::Update(const std::vector<std::string>& args,
 
 int Auracle::GetOutdatedPackages(const std::vector<std::string>& args,
                                  std::vector<aur::Package>* packages) {
+  // Callers only look at what's outdated, and what it would be updated to.
   aur::InfoRequest info_request;
+  info_request.set_fields(
+      {aur::PackageField::NAME, aur::PackageField::VERSION});
 
   auto local_pkgs = pacman_->LocalPackages();
   for (const auto& pkg : local_pkgs) {
@@ -739,12 +1082,106 @@ int RawRequestDone(absl::StatusOr<aur::RawResponse> response) {
     return -EIO;
   }
 
-  std::println("{}", response.value().bytes);
+  response.value().WriteTo(stdout);
   return 0;
 }
 
 }  // namespace
 
+int Auracle::SyncMetadata(const std::vector<std::string>& args,
+                          const CommandOptions& options) {
+  if (args.size() > 1) {
+    std::println(stderr, "error: too many arguments.");
+    return -EINVAL;
+  }
+
+  if (metadata_file_.empty()) {
+    std::println(stderr, "error: no location given for the metadata index.");
+    return -EINVAL;
+  }
+
+  std::string metadata;
+  if (!args.empty()) {
+    std::ifstream file(args[0], std::ios::binary);
+    if (!file.is_open()) {
+      std::println(stderr, "error: failed to open {}", args[0]);
+      return -ENOENT;
+    }
+
+    metadata.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+  } else {
+    client_->QueueRawRequest(
+        aur::RawRequest("/packages-meta-ext-v1.json.gz"),
+        [&](absl::StatusOr<aur::RawResponse> response) {
+          if (!response.ok()) {
+            std::println(stderr, "error: request failed: {}",
+                         response.status().ToString());
+            return -EIO;
+          }
+
+          metadata = std::move(response.value().bytes);
+          return 0;
+        });
+
+    int r = client_->Wait();
+    if (r < 0) {
+      return r;
+    }
+  }
+
+  const auto response = aur::MetadataResponse::Parse(metadata);
+  if (!response.ok()) {
+    std::println(stderr, "error: invalid metadata: {}",
+                 response.status().message());
+    return -EINVAL;
+  }
+
+  const auto status =
+      aur::MetadataIndex::Write(metadata_file_, response->packages);
+  if (!status.ok()) {
+    std::println(stderr, "error: {}", status.message());
+    return -EIO;
+  }
+
+  if (!options.quiet) {
+    std::println("synced metadata for {} packages to {}",
+                 response->packages.size(), metadata_file_);
+  }
+
+  return 0;
+}
+
+int Auracle::WhatDepends(const std::vector<std::string>& args,
+                         const CommandOptions& options) {
+  if (args.empty()) {
+    return ErrorNotEnoughArgs();
+  }
+
+  DependentIterator iter(options.recurse, options.resolve_depends);
+  for (const auto& arg : args) {
+    IterateDependents(Dependency(arg).name(), &iter);
+  }
+
+  int r = client_->Wait();
+  if (r < 0) {
+    return r;
+  }
+
+  auto& dependents = iter.dependents;
+  SortUnique(dependents, options.sorter);
+
+  if (!options.format.empty()) {
+    FormatCustom(dependents, options.format);
+  } else if (options.quiet) {
+    FormatNameOnly(dependents);
+  } else {
+    FormatShort(dependents, pacman_);
+  }
+
+  return 0;
+}
+
 int Auracle::RawSearch(const std::vector<std::string>& args,
                        const CommandOptions& options) {
   for (const auto& arg : args) {
@@ -6,8 +6,11 @@
 #include <vector>
 
 #include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "aur/client.hh"
 #include "aur/request.hh"
+#include "aur/request_stats.hh"
 #include "auracle/dependency.hh"
 #include "auracle/dependency_kind.hh"
 #include "auracle/package_cache.hh"
@@ -39,10 +42,79 @@ class Auracle {
       return *this;
     }
 
+    Options& set_cache_directory(std::optional<std::string> cache_directory) {
+      this->cache_directory = std::move(cache_directory);
+      return *this;
+    }
+
+    Options& set_cache_ttl(std::optional<absl::Duration> cache_ttl) {
+      this->cache_ttl = cache_ttl;
+      return *this;
+    }
+
+    Options& set_max_parallel_clones(std::optional<int> max_parallel_clones) {
+      this->max_parallel_clones = max_parallel_clones;
+      return *this;
+    }
+
+    Options& set_max_requests_per_second(
+        std::optional<double> max_requests_per_second) {
+      this->max_requests_per_second = max_requests_per_second;
+      return *this;
+    }
+
+    Options& set_max_connections(std::optional<int> max_connections) {
+      this->max_connections = max_connections;
+      return *this;
+    }
+
+    Options& set_max_streams_per_connection(
+        std::optional<int> max_streams_per_connection) {
+      this->max_streams_per_connection = max_streams_per_connection;
+      return *this;
+    }
+
+    Options& set_connect_timeout(
+        std::optional<absl::Duration> connect_timeout) {
+      this->connect_timeout = connect_timeout;
+      return *this;
+    }
+
+    Options& set_keepalive(std::optional<absl::Duration> keepalive) {
+      this->keepalive = keepalive;
+      return *this;
+    }
+
+    Options& set_metadata_file(std::string metadata_file) {
+      this->metadata_file = std::move(metadata_file);
+      return *this;
+    }
+
+    Options& set_offline(bool offline) {
+      this->offline = offline;
+      return *this;
+    }
+
+    Options& set_stats(aur::RequestStats* stats) {
+      this->stats = stats;
+      return *this;
+    }
+
     std::string baseurl;
     std::optional<std::string> proxy;
     Pacman* pacman = nullptr;
     bool quiet = false;
+    std::optional<std::string> cache_directory;
+    std::optional<absl::Duration> cache_ttl;
+    std::optional<int> max_parallel_clones;
+    std::optional<double> max_requests_per_second;
+    std::optional<int> max_connections;
+    std::optional<int> max_streams_per_connection;
+    std::optional<absl::Duration> connect_timeout;
+    std::optional<absl::Duration> keepalive;
+    std::string metadata_file;
+    bool offline = false;
+    aur::RequestStats* stats = nullptr;
   };
 
   explicit Auracle(Options options);
@@ -65,7 +137,15 @@ class Auracle {
     std::string show_file = "PKGBUILD";
     sort::Sorter sorter =
         sort::MakePackageSorter("name", sort::OrderBy::ORDER_ASC);
+    sort::ViewSorter view_sorter =
+        sort::MakePackageViewSorter("name", sort::OrderBy::ORDER_ASC);
     std::string format;
+    int clone_depth = 0;
+    std::string clone_filter;
+    bool snapshot = false;
+    enum class BuildWaves : int8_t { NONE, TEXT, JSON };
+    BuildWaves build_waves = BuildWaves::NONE;
+    std::string build_costs_file;
     absl::btree_set<DependencyKind> resolve_depends = {
         DependencyKind::Depend, DependencyKind::CheckDepend,
         DependencyKind::MakeDepend};
@@ -89,6 +169,10 @@ class Auracle {
                const CommandOptions& options);
   int Update(const std::vector<std::string>& args,
              const CommandOptions& options);
+  int SyncMetadata(const std::vector<std::string>& args,
+                   const CommandOptions& options);
+  int WhatDepends(const std::vector<std::string>& args,
+                  const CommandOptions& options);
 
  private:
   struct PackageIterator {
@@ -106,6 +190,21 @@ class Auracle {
 
     const PackageCallback callback;
     PackageCache package_cache;
+
+    // Names which have been asked for, including those still in flight.
+    absl::flat_hash_set<std::string> requested;
+  };
+
+  struct DependentIterator {
+    DependentIterator(bool recurse,
+                      absl::btree_set<DependencyKind> resolve_depends)
+        : recurse(recurse), resolve_depends(resolve_depends) {}
+
+    bool recurse;
+    absl::btree_set<DependencyKind> resolve_depends;
+
+    absl::flat_hash_set<std::string> queried;
+    std::vector<aur::Package> dependents;
   };
 
   void ResolveMany(const std::vector<std::string>& depstrings,
@@ -116,8 +215,16 @@ class Auracle {
 
   void IteratePackages(std::vector<std::string> args, PackageIterator* state);
 
+  void IterateDependents(const std::string& name, DependentIterator* state);
+
+  // Fetches the sources of |package| into the current directory, either with
+  // git or as a snapshot, as |options| dictate. |ret| is set on failure.
+  void QueueSourceDownload(const aur::Package& package,
+                           const CommandOptions& options, int* ret);
+
   std::unique_ptr<aur::Client> client_;
   Pacman* pacman_;
+  std::string metadata_file_;
 };
 
 }  // namespace auracle
@@ -64,48 +64,45 @@ bool Dependency::SatisfiedByVersion(const std::string& version) const {
   return false;
 }
 
-bool Dependency::SatisfiedBy(const aur::Package& candidate) const {
+bool Dependency::SatisfiedByName(const aur::Package& candidate) const {
+  // Exact match on package name, and a satisfied version if needed.
+  return name_ == candidate.name &&
+         (version_.empty() || SatisfiedByVersion(candidate.version));
+}
+
+bool Dependency::SatisfiedByProvide(const Dependency& provide) const {
+  if (name_ != provide.name_) {
+    return false;
+  }
+
+  // Without a version, any provide of the name will do.
   if (version_.empty()) {
-    // exact match on package name
-    if (name_ == candidate.name) {
-      return true;
-    }
+    return true;
+  }
 
-    // Satisfied via provides without version comparison.
-    for (const auto& depstring : candidate.provides) {
-      if (name_ == Dependency(depstring).name_) {
-        return true;
-      }
-    }
-  } else {  // !version_.empty()
-    // Exact match on package name and satisfied version
-    if (name_ == candidate.name && SatisfiedByVersion(candidate.version)) {
-      return true;
-    }
+  // An unversioned or malformed provide can't satisfy a versioned dependency.
+  return provide.mod_ == Mod::EQ && SatisfiedByVersion(provide.version_);
+}
 
-    // Satisfied via provides with version comparison.
-    for (const auto& depstring : candidate.provides) {
-      Dependency provide(depstring);
-
-      // An unversioned or malformed provide can't satisfy a versioned
-      // dependency.
-      if (provide.mod_ != Mod::EQ) {
-        continue;
-      }
-
-      // Names must match.
-      if (name_ != provide.name_) {
-        continue;
-      }
-
-      // Compare versions.
-      if (SatisfiedByVersion(provide.version_)) {
-        return true;
-      }
-    }
+bool Dependency::SatisfiedBy(const aur::Package& candidate) const {
+  if (SatisfiedByName(candidate)) {
+    return true;
   }
 
-  return false;
+  return absl::c_any_of(candidate.provides, [&](const std::string& depstring) {
+    return SatisfiedByProvide(Dependency(depstring));
+  });
+}
+
+bool Dependency::SatisfiedBy(const aur::Package& candidate,
+                             std::span<const Dependency> provides) const {
+  if (SatisfiedByName(candidate)) {
+    return true;
+  }
+
+  return absl::c_any_of(provides, [&](const Dependency& provide) {
+    return SatisfiedByProvide(provide);
+  });
 }
 
 }  // namespace auracle
@@ -2,6 +2,7 @@
 #ifndef AURACLE_DEPENDENCY_HH_
 #define AURACLE_DEPENDENCY_HH_
 
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -35,6 +36,11 @@ class Dependency final {
   //     satisfy a versioned dependency.
   bool SatisfiedBy(const aur::Package& candidate) const;
 
+  // As above, but with the |candidate|'s provides already parsed, avoiding the
+  // cost of parsing them again on each call.
+  bool SatisfiedBy(const aur::Package& candidate,
+                   std::span<const Dependency> provides) const;
+
  private:
   enum class Mod {
     ANY,
@@ -46,6 +52,8 @@ class Dependency final {
   };
 
   bool SatisfiedByVersion(const std::string& version) const;
+  bool SatisfiedByName(const aur::Package& candidate) const;
+  bool SatisfiedByProvide(const Dependency& provide) const;
 
   std::string depstring_;
   std::string name_;
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+#include "auracle/dependency.hh"
+
+#include <vector>
+
+#include "aur/package.hh"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+void BM_DependencyConstruct(benchmark::State& state) {
+  for (auto _ : state) {
+    for (const char* depstring :
+         {"glibc", "libcurl.so", "python>=3.7", "pacman<6.2", "foo=1:2.3-4"}) {
+      auracle::Dependency dep(depstring);
+      benchmark::DoNotOptimize(dep);
+    }
+  }
+}
+BENCHMARK(BM_DependencyConstruct);
+
+aur::Package MakeCandidate() {
+  aur::Package candidate;
+  candidate.name = "auracle-git";
+  candidate.version = "r74.82e863f-1";
+  candidate.provides = {"auracle=r74.82e863f", "libaur.so", "aur-helper"};
+  return candidate;
+}
+
+void BM_DependencySatisfiedByName(benchmark::State& state) {
+  const auracle::Dependency dep("auracle-git>=r70");
+  const aur::Package candidate = MakeCandidate();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dep.SatisfiedBy(candidate));
+  }
+}
+BENCHMARK(BM_DependencySatisfiedByName);
+
+void BM_DependencySatisfiedByProvide(benchmark::State& state) {
+  const auracle::Dependency dep("auracle>=r70");
+  const aur::Package candidate = MakeCandidate();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dep.SatisfiedBy(candidate));
+  }
+}
+BENCHMARK(BM_DependencySatisfiedByProvide);
+
+void BM_DependencySatisfiedByParsedProvide(benchmark::State& state) {
+  const auracle::Dependency dep("auracle>=r70");
+  const aur::Package candidate = MakeCandidate();
+
+  std::vector<auracle::Dependency> provides;
+  for (const auto& provide : candidate.provides) {
+    provides.emplace_back(provide);
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dep.SatisfiedBy(candidate, provides));
+  }
+}
+BENCHMARK(BM_DependencySatisfiedByParsedProvide);
+
+void BM_DependencyNotSatisfied(benchmark::State& state) {
+  const auracle::Dependency dep("cower");
+  const aur::Package candidate = MakeCandidate();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dep.SatisfiedBy(candidate));
+  }
+}
+BENCHMARK(BM_DependencyNotSatisfied);
+
+}  // namespace
@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: MIT
+#include "auracle/dependency_graph.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "auracle/dependency.hh"
+
+namespace auracle {
+
+namespace {
+
+// Finds the strongly connected components of the graph whose edges are given
+// by |depends|, with Tarjan's algorithm. Components are returned in the order
+// they're completed, which puts each after every component it depends on.
+std::vector<std::vector<int>> FindComponents(
+    const std::vector<std::vector<int>>& depends) {
+  std::vector<int> index(depends.size(), -1);
+  std::vector<int> lowlink(depends.size());
+  std::vector<bool> on_stack(depends.size());
+  int next_index = 0;
+
+  std::vector<int> stack;
+  std::vector<std::vector<int>> components;
+
+  struct Frame {
+    int idx;
+    // The next dependency to visit.
+    size_t next = 0;
+  };
+  std::vector<Frame> frames;
+
+  const auto visit = [&](int idx) {
+    index[idx] = lowlink[idx] = next_index++;
+    stack.push_back(idx);
+    on_stack[idx] = true;
+    frames.push_back({.idx = idx});
+  };
+
+  for (size_t root = 0; root < depends.size(); ++root) {
+    if (index[root] != -1) {
+      continue;
+    }
+
+    visit(root);
+    while (!frames.empty()) {
+      auto& frame = frames.back();
+      const int idx = frame.idx;
+
+      if (frame.next < depends[idx].size()) {
+        const int dep = depends[idx][frame.next++];
+        if (index[dep] == -1) {
+          // This grows the stack, invalidating |frame|.
+          visit(dep);
+        } else if (on_stack[dep]) {
+          lowlink[idx] = std::min(lowlink[idx], index[dep]);
+        }
+        continue;
+      }
+
+      if (lowlink[idx] == index[idx]) {
+        auto& component = components.emplace_back();
+        int member;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          on_stack[member] = false;
+          component.push_back(member);
+        } while (member != idx);
+        absl::c_sort(component);
+      }
+
+      frames.pop_back();
+      if (!frames.empty()) {
+        const int parent = frames.back().idx;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[idx]);
+      }
+    }
+  }
+
+  return components;
+}
+
+}  // namespace
+
+DependencyGraph::DependencyGraph(
+    const PackageCache& cache, const std::vector<const aur::Package*>& packages,
+    const absl::btree_set<DependencyKind>& dependency_kinds) {
+  absl::flat_hash_map<std::string, int> index_by_pkgbase;
+  for (const auto* package : packages) {
+    const auto [iter, inserted] =
+        index_by_pkgbase.try_emplace(package->pkgbase, nodes_.size());
+    if (inserted) {
+      nodes_.emplace_back().pkgbase = package->pkgbase;
+    }
+    nodes_[iter->second].packages.push_back(package);
+  }
+
+  std::vector<std::vector<int>> depends(nodes_.size());
+  for (size_t idx = 0; idx < nodes_.size(); ++idx) {
+    auto& node = nodes_[idx];
+    for (const auto* package : node.packages) {
+      for (auto kind : dependency_kinds) {
+        for (const auto& depstring : GetDependenciesByKind(package, kind)) {
+          const auto* dep = cache.LookupByPkgname(Dependency(depstring).name());
+          if (dep == nullptr) {
+            continue;
+          }
+
+          const auto iter = index_by_pkgbase.find(dep->pkgbase);
+          if (iter == index_by_pkgbase.end()) {
+            continue;
+          }
+
+          // Skip edges within the pkgbase, and those that we already have.
+          const int dep_idx = iter->second;
+          if (dep_idx == static_cast<int>(idx) ||
+              absl::c_linear_search(node.depends, dep_idx)) {
+            continue;
+          }
+
+          node.depends.push_back(dep_idx);
+        }
+      }
+    }
+    depends[idx] = node.depends;
+  }
+
+  components_ = FindComponents(depends);
+
+  component_of_.resize(nodes_.size());
+  for (size_t c = 0; c < components_.size(); ++c) {
+    for (const int idx : components_[c]) {
+      component_of_[idx] = c;
+    }
+  }
+
+  component_depends_.resize(components_.size());
+  for (size_t c = 0; c < components_.size(); ++c) {
+    auto& component_depends = component_depends_[c];
+    for (const int idx : components_[c]) {
+      for (const int dep : nodes_[idx].depends) {
+        const int dep_component = component_of_[dep];
+        if (dep_component != static_cast<int>(c) &&
+            !absl::c_linear_search(component_depends, dep_component)) {
+          component_depends.push_back(dep_component);
+        }
+      }
+    }
+  }
+
+  // Number the cycles by their first members.
+  int cycle = 0;
+  for (size_t idx = 0; idx < nodes_.size(); ++idx) {
+    const auto& component = components_[component_of_[idx]];
+    if (component.size() > 1 && component.front() == static_cast<int>(idx)) {
+      for (const int idx : component) {
+        nodes_[idx].cycle = cycle;
+      }
+      ++cycle;
+    }
+  }
+}
+
+std::vector<std::vector<int>> DependencyGraph::Waves() const {
+  // Components come after their dependencies, so each one's wave is known by
+  // the time it's reached.
+  std::vector<int> wave_of(components_.size());
+  std::vector<std::vector<int>> components_by_wave;
+  for (size_t c = 0; c < components_.size(); ++c) {
+    for (const int dep : component_depends_[c]) {
+      wave_of[c] = std::max(wave_of[c], wave_of[dep] + 1);
+    }
+
+    if (static_cast<size_t>(wave_of[c]) == components_by_wave.size()) {
+      components_by_wave.emplace_back();
+    }
+    components_by_wave[wave_of[c]].push_back(c);
+  }
+
+  std::vector<std::vector<int>> waves;
+  waves.reserve(components_by_wave.size());
+  for (auto& components : components_by_wave) {
+    // Keep each wave in the order that the nodes were given, as far as cycles
+    // allow.
+    absl::c_sort(components, [&](int a, int b) {
+      return components_[a].front() < components_[b].front();
+    });
+
+    auto& wave = waves.emplace_back();
+    for (const int c : components) {
+      absl::c_copy(components_[c], std::back_inserter(wave));
+    }
+  }
+
+  return waves;
+}
+
+DependencyGraph::Schedule DependencyGraph::ComputeSchedule(
+    const std::vector<double>& costs) const {
+  Schedule schedule;
+  if (nodes_.empty()) {
+    return schedule;
+  }
+
+  // Each component is built as a unit, taking as long as all of its members.
+  // Components come after their dependencies, so they're already in a
+  // topological order.
+  std::vector<double> component_costs(components_.size());
+  std::vector<double> earliest_start(components_.size());
+  std::vector<double> earliest_finish(components_.size());
+  for (size_t c = 0; c < components_.size(); ++c) {
+    for (const int idx : components_[c]) {
+      component_costs[c] += costs[idx];
+    }
+    for (const int dep : component_depends_[c]) {
+      earliest_start[c] = std::max(earliest_start[c], earliest_finish[dep]);
+    }
+    earliest_finish[c] = earliest_start[c] + component_costs[c];
+  }
+
+  const auto last = absl::c_max_element(earliest_finish);
+  schedule.makespan = *last;
+
+  // Work backwards to find the latest that each component could finish
+  // without delaying any of its dependents.
+  std::vector<double> latest_finish(components_.size(), schedule.makespan);
+  for (int c = components_.size() - 1; c >= 0; --c) {
+    const double latest_start = latest_finish[c] - component_costs[c];
+    for (const int dep : component_depends_[c]) {
+      latest_finish[dep] = std::min(latest_finish[dep], latest_start);
+    }
+  }
+
+  schedule.earliest_start.resize(nodes_.size());
+  schedule.slack.resize(nodes_.size());
+  for (size_t idx = 0; idx < nodes_.size(); ++idx) {
+    const int c = component_of_[idx];
+    schedule.earliest_start[idx] = earliest_start[c];
+    schedule.slack[idx] = latest_finish[c] - earliest_finish[c];
+  }
+
+  // Follow the chain back from the component that finishes last, through the
+  // dependencies that held up the start of each component.
+  std::vector<int> path;
+  int c = last - earliest_finish.begin();
+  for (;;) {
+    path.push_back(c);
+
+    const auto& depends = component_depends_[c];
+    const auto blocker = absl::c_find_if(depends, [&](int dep) {
+      return earliest_finish[dep] == earliest_start[c];
+    });
+    if (blocker == depends.end()) {
+      break;
+    }
+    c = *blocker;
+  }
+
+  for (auto iter = path.crbegin(); iter != path.crend(); ++iter) {
+    absl::c_copy(components_[*iter],
+                 std::back_inserter(schedule.critical_path));
+  }
+
+  return schedule;
+}
+
+absl::StatusOr<absl::flat_hash_map<std::string, double>> ParseBuildCosts(
+    std::string_view contents) {
+  absl::flat_hash_map<std::string, double> costs;
+
+  int lineno = 0;
+  for (const auto line : absl::StrSplit(contents, '\n')) {
+    ++lineno;
+
+    const auto stripped = absl::StripAsciiWhitespace(line);
+    if (stripped.empty() || absl::StartsWith(stripped, "#")) {
+      continue;
+    }
+
+    const std::vector<std::string_view> fields =
+        absl::StrSplit(stripped, absl::ByAnyChar(" \t"), absl::SkipEmpty());
+    double seconds;
+    if (fields.size() != 2 || !absl::SimpleAtod(fields[1], &seconds) ||
+        !std::isfinite(seconds) || seconds < 0) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("line %d: expected a pkgbase and a number of "
+                          "seconds, got: %s",
+                          lineno, stripped));
+    }
+
+    costs[fields[0]] = seconds;
+  }
+
+  return costs;
+}
+
+}  // namespace auracle
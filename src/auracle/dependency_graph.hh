@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: MIT
+#ifndef AURACLE_DEPENDENCY_GRAPH_HH_
+#define AURACLE_DEPENDENCY_GRAPH_HH_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "aur/package.hh"
+#include "auracle/dependency_kind.hh"
+#include "auracle/package_cache.hh"
+
+namespace auracle {
+
+// DependencyGraph is the graph of what needs building to build a set of AUR
+// packages. Each node is a pkgbase, as that's the unit that gets built, and
+// edges point from a pkgbase to the pkgbases it depends on.
+//
+// Pkgbases which depend on each other, directly or otherwise, form a cycle.
+// None of them can be built before the others, so each cycle is built as a
+// single unit.
+class DependencyGraph {
+ public:
+  struct Node {
+    std::string pkgbase;
+
+    // The packages from this pkgbase that are part of the graph.
+    std::vector<const aur::Package*> packages;
+
+    // The indices of the nodes that this one depends on, including any other
+    // members of its cycle.
+    std::vector<int> depends;
+
+    // The index of the cycle that this node is a member of, counting from 0 in
+    // the order that the cycles' first members were given, or -1 if it isn't
+    // part of a cycle.
+    int cycle = -1;
+  };
+
+  // Builds the graph of the given |packages|, in the order given, e.g. as
+  // visited by PackageCache::WalkDependencies. Dependencies are resolved
+  // against |cache|, following only those of |dependency_kinds|.
+  DependencyGraph(const PackageCache& cache,
+                  const std::vector<const aur::Package*>& packages,
+                  const absl::btree_set<DependencyKind>& dependency_kinds);
+
+  DependencyGraph(const DependencyGraph&) = delete;
+  DependencyGraph& operator=(const DependencyGraph&) = delete;
+
+  DependencyGraph(DependencyGraph&&) = default;
+  DependencyGraph& operator=(DependencyGraph&&) = default;
+
+  // The nodes of the graph, in the order that their packages were given.
+  const std::vector<Node>& nodes() const { return nodes_; }
+
+  // Groups the nodes into waves. Each wave holds the nodes whose dependencies
+  // are all in earlier waves, so every node within a wave can be built in
+  // parallel. The members of a cycle share a wave, and are adjacent within it.
+  std::vector<std::vector<int>> Waves() const;
+
+  // When each node can be built, given unlimited builders. The members of a
+  // cycle are scheduled as one unit, which takes as long as all of them, so
+  // they share a start time and slack.
+  struct Schedule {
+    // The earliest time that each node can start building, once all of its
+    // dependencies have been built.
+    std::vector<double> earliest_start;
+
+    // How long each node's build can be delayed without delaying the build of
+    // the whole graph. Nodes on a critical path have no slack.
+    std::vector<double> slack;
+
+    // The longest chain of dependencies, from the first node built to the
+    // last, which bounds how long building the whole graph takes.
+    std::vector<int> critical_path;
+
+    // How long building the whole graph takes.
+    double makespan = 0;
+  };
+
+  // Schedules the build of the graph, where |costs| holds the time taken to
+  // build each node. All times are in seconds.
+  Schedule ComputeSchedule(const std::vector<double>& costs) const;
+
+ private:
+  std::vector<Node> nodes_;
+
+  // The strongly connected components of the graph, each of which is either a
+  // cycle or a single node. Components come after those they depend on, and
+  // their members are in the order given.
+  std::vector<std::vector<int>> components_;
+  std::vector<int> component_of_;
+
+  // The indices of the other components that each component depends on.
+  std::vector<std::vector<int>> component_depends_;
+};
+
+// Parses a file of historical build times, mapping pkgbases to the number of
+// seconds they take to build. Each line holds a pkgbase and its build time,
+// separated by whitespace. Blank lines and lines starting with '#' are ignored.
+absl::StatusOr<absl::flat_hash_map<std::string, double>> ParseBuildCosts(
+    std::string_view contents);
+
+}  // namespace auracle
+
+#endif  // AURACLE_DEPENDENCY_GRAPH_HH_
@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: MIT
+#include "auracle/dependency_graph.hh"
+
+#include "absl/algorithm/container.h"
+#include "aur/package.hh"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using auracle::DependencyGraph;
+using auracle::DependencyKind;
+using auracle::PackageCache;
+using testing::ElementsAre;
+using testing::Field;
+using testing::IsEmpty;
+using testing::Pair;
+using testing::UnorderedElementsAre;
+
+namespace {
+
+class DependencyGraphTest : public testing::Test {
+ protected:
+  void AddPackage(int id, std::string name, std::string pkgbase,
+                  std::vector<std::string> depends,
+                  std::vector<std::string> makedepends = {}) {
+    aur::Package package;
+    package.package_id = id;
+    package.pkgbase_id = id;
+    package.name = std::move(name);
+    package.pkgbase = std::move(pkgbase);
+    package.depends = std::move(depends);
+    package.makedepends = std::move(makedepends);
+    cache_.AddPackage(std::move(package));
+  }
+
+  // Builds the graph in the order that buildorder would.
+  DependencyGraph BuildGraph(
+      const std::vector<std::string>& targets,
+      const absl::btree_set<DependencyKind>& kinds = {
+          DependencyKind::Depend, DependencyKind::MakeDepend}) {
+    std::vector<const aur::Package*> packages;
+    for (const auto& target : targets) {
+      cache_.WalkDependencies(
+          target,
+          [&](const auracle::Dependency&, const aur::Package* package,
+              const std::vector<std::string>&) {
+            if (package != nullptr &&
+                !absl::c_linear_search(packages, package)) {
+              packages.push_back(package);
+            }
+          },
+          kinds);
+    }
+    return DependencyGraph(cache_, packages, kinds);
+  }
+
+  std::vector<std::vector<std::string>> Waves(const DependencyGraph& graph) {
+    std::vector<std::vector<std::string>> waves;
+    for (const auto& wave : graph.Waves()) {
+      auto& pkgbases = waves.emplace_back();
+      for (const int idx : wave) {
+        pkgbases.push_back(graph.nodes()[idx].pkgbase);
+      }
+    }
+    return waves;
+  }
+
+  PackageCache cache_;
+};
+
+TEST_F(DependencyGraphTest, GroupsIndependentPackages) {
+  AddPackage(1, "app", "app", {"lib-a", "lib-b", "glibc"});
+  AddPackage(2, "lib-a", "lib-a", {"lib-c"});
+  AddPackage(3, "lib-b", "lib-b", {}, {"lib-c"});
+  AddPackage(4, "lib-c", "lib-c", {"glibc"});
+
+  const auto graph = BuildGraph({"app"});
+
+  EXPECT_THAT(Waves(graph), ElementsAre(ElementsAre("lib-c"),
+                                        ElementsAre("lib-a", "lib-b"),
+                                        ElementsAre("app")));
+}
+
+TEST_F(DependencyGraphTest, FollowsOnlyRequestedDependencyKinds) {
+  AddPackage(1, "app", "app", {"lib-a", "lib-b"});
+  AddPackage(2, "lib-a", "lib-a", {"lib-c"});
+  AddPackage(3, "lib-b", "lib-b", {}, {"lib-c"});
+  AddPackage(4, "lib-c", "lib-c", {});
+
+  const auto graph = BuildGraph({"app"}, {DependencyKind::Depend});
+
+  EXPECT_THAT(Waves(graph), ElementsAre(ElementsAre("lib-c", "lib-b"),
+                                        ElementsAre("lib-a"),
+                                        ElementsAre("app")));
+}
+
+TEST_F(DependencyGraphTest, MergesPackagesOfThePkgbase) {
+  AddPackage(1, "app", "app", {"foo"});
+  AddPackage(2, "foo", "foo-split", {"foo-libs"});
+  AddPackage(3, "foo-libs", "foo-split", {});
+
+  const auto graph = BuildGraph({"app"});
+
+  ASSERT_EQ(graph.nodes().size(), 2);
+  EXPECT_EQ(graph.nodes()[0].pkgbase, "foo-split");
+  EXPECT_EQ(graph.nodes()[0].packages.size(), 2);
+  EXPECT_THAT(graph.nodes()[0].depends, IsEmpty());
+  EXPECT_THAT(graph.nodes()[1].depends, ElementsAre(0));
+
+  EXPECT_THAT(Waves(graph),
+              ElementsAre(ElementsAre("foo-split"), ElementsAre("app")));
+}
+
+TEST_F(DependencyGraphTest, KeepsDependenciesOfLaterPackagesOfThePkgbase) {
+  AddPackage(1, "x", "x", {"a1", "a2"});
+  AddPackage(2, "a1", "a", {});
+  AddPackage(3, "a2", "a", {"b"});
+  AddPackage(4, "b", "b", {});
+
+  const auto graph = BuildGraph({"x"});
+  ASSERT_THAT(graph.nodes(),
+              ElementsAre(Field(&DependencyGraph::Node::pkgbase, "a"),
+                          Field(&DependencyGraph::Node::pkgbase, "b"),
+                          Field(&DependencyGraph::Node::pkgbase, "x")));
+  EXPECT_THAT(graph.nodes()[0].depends, ElementsAre(1));
+
+  EXPECT_THAT(Waves(graph), ElementsAre(ElementsAre("b"), ElementsAre("a"),
+                                        ElementsAre("x")));
+}
+
+TEST_F(DependencyGraphTest, BuildsCyclesTogether) {
+  AddPackage(1, "app", "app", {"a", "lib"});
+  AddPackage(2, "a", "a", {"b"});
+  AddPackage(3, "b", "b", {"c"});
+  AddPackage(4, "c", "c", {"a", "lib"});
+  AddPackage(5, "lib", "lib", {});
+
+  const auto graph = BuildGraph({"app"});
+
+  ASSERT_THAT(graph.nodes(),
+              ElementsAre(Field(&DependencyGraph::Node::pkgbase, "lib"),
+                          Field(&DependencyGraph::Node::pkgbase, "c"),
+                          Field(&DependencyGraph::Node::pkgbase, "b"),
+                          Field(&DependencyGraph::Node::pkgbase, "a"),
+                          Field(&DependencyGraph::Node::pkgbase, "app")));
+  EXPECT_THAT(graph.nodes(),
+              ElementsAre(Field(&DependencyGraph::Node::cycle, -1),
+                          Field(&DependencyGraph::Node::cycle, 0),
+                          Field(&DependencyGraph::Node::cycle, 0),
+                          Field(&DependencyGraph::Node::cycle, 0),
+                          Field(&DependencyGraph::Node::cycle, -1)));
+
+  EXPECT_THAT(Waves(graph),
+              ElementsAre(ElementsAre("lib"), ElementsAre("c", "b", "a"),
+                          ElementsAre("app")));
+}
+
+TEST_F(DependencyGraphTest, SchedulesCriticalPath) {
+  AddPackage(1, "app", "app", {"lib-a", "lib-b"});
+  AddPackage(2, "lib-a", "lib-a", {"lib-c"});
+  AddPackage(3, "lib-b", "lib-b", {"lib-c"});
+  AddPackage(4, "lib-c", "lib-c", {});
+
+  const auto graph = BuildGraph({"app"});
+  ASSERT_THAT(graph.nodes(),
+              ElementsAre(Field(&DependencyGraph::Node::pkgbase, "lib-c"),
+                          Field(&DependencyGraph::Node::pkgbase, "lib-a"),
+                          Field(&DependencyGraph::Node::pkgbase, "lib-b"),
+                          Field(&DependencyGraph::Node::pkgbase, "app")));
+
+  const auto schedule = graph.ComputeSchedule({10, 5, 30, 1});
+
+  EXPECT_EQ(schedule.makespan, 41);
+  EXPECT_THAT(schedule.earliest_start, ElementsAre(0, 10, 10, 40));
+  EXPECT_THAT(schedule.slack, ElementsAre(0, 25, 0, 0));
+  EXPECT_THAT(schedule.critical_path, ElementsAre(0, 2, 3));
+}
+
+TEST_F(DependencyGraphTest, SchedulesLaterPackagesOfThePkgbase) {
+  AddPackage(1, "x", "x", {"a1", "a2"});
+  AddPackage(2, "a1", "a", {});
+  AddPackage(3, "a2", "a", {"b"});
+  AddPackage(4, "b", "b", {});
+
+  // a, b, x
+  const auto schedule = BuildGraph({"x"}).ComputeSchedule({10, 30, 1});
+
+  EXPECT_EQ(schedule.makespan, 41);
+  EXPECT_THAT(schedule.earliest_start, ElementsAre(30, 0, 40));
+  EXPECT_THAT(schedule.slack, ElementsAre(0, 0, 0));
+  EXPECT_THAT(schedule.critical_path, ElementsAre(1, 0, 2));
+}
+
+TEST_F(DependencyGraphTest, SchedulesCyclesAsOneUnit) {
+  AddPackage(1, "app", "app", {"a", "lib", "slow"});
+  AddPackage(2, "a", "a", {"b"});
+  AddPackage(3, "b", "b", {"a", "lib"});
+  AddPackage(4, "lib", "lib", {});
+  AddPackage(5, "slow", "slow", {});
+
+  const auto graph = BuildGraph({"app"});
+  ASSERT_THAT(graph.nodes(),
+              ElementsAre(Field(&DependencyGraph::Node::pkgbase, "lib"),
+                          Field(&DependencyGraph::Node::pkgbase, "b"),
+                          Field(&DependencyGraph::Node::pkgbase, "a"),
+                          Field(&DependencyGraph::Node::pkgbase, "slow"),
+                          Field(&DependencyGraph::Node::pkgbase, "app")));
+
+  const auto schedule = graph.ComputeSchedule({5, 1, 2, 4, 1});
+
+  EXPECT_EQ(schedule.makespan, 9);
+  EXPECT_THAT(schedule.earliest_start, ElementsAre(0, 5, 5, 0, 8));
+  EXPECT_THAT(schedule.slack, ElementsAre(0, 0, 0, 4, 0));
+  EXPECT_THAT(schedule.critical_path, ElementsAre(0, 1, 2, 4));
+}
+
+TEST_F(DependencyGraphTest, SchedulesNothing) {
+  const auto schedule = BuildGraph({}).ComputeSchedule({});
+
+  EXPECT_EQ(schedule.makespan, 0);
+  EXPECT_THAT(schedule.critical_path, IsEmpty());
+}
+
+TEST(BuildCostsTest, ParsesBuildCosts) {
+  const auto costs = auracle::ParseBuildCosts(
+      "# pkgbase seconds\n"
+      "chromium 7200\n"
+      "\n"
+      "  ocaml-base\t12.5  \n");
+  ASSERT_TRUE(costs.ok()) << costs.status();
+
+  EXPECT_THAT(*costs, UnorderedElementsAre(Pair("chromium", 7200),
+                                           Pair("ocaml-base", 12.5)));
+}
+
+TEST(BuildCostsTest, RejectsMalformedBuildCosts) {
+  for (const auto* contents :
+       {"chromium", "chromium forever", "chromium -1", "chromium nan",
+        "chromium inf", "chromium -inf", "chromium 1 2", "ok 1\nchromium"}) {
+    EXPECT_TRUE(absl::IsInvalidArgument(
+        auracle::ParseBuildCosts(contents).status()))
+        << contents;
+  }
+}
+
+}  // namespace
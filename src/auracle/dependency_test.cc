@@ -158,4 +158,20 @@ TEST(DependencyTest, MalformedProvider) {
   EXPECT_FALSE(dep.SatisfiedBy(foo));
 }
 
+TEST(DependencyTest, PreparsedProvides) {
+  Package bar;
+  bar.name = "bar";
+  bar.version = "1.0.0";
+
+  const std::vector<Dependency> provides = {Dependency("quux"),
+                                            Dependency("foo=1.0.0")};
+
+  EXPECT_TRUE(Dependency("bar=1.0.0").SatisfiedBy(bar, provides));
+  EXPECT_TRUE(Dependency("quux").SatisfiedBy(bar, provides));
+  EXPECT_FALSE(Dependency("quux>1").SatisfiedBy(bar, provides));
+  EXPECT_TRUE(Dependency("foo>=0.9").SatisfiedBy(bar, provides));
+  EXPECT_FALSE(Dependency("foo>1.0.0").SatisfiedBy(bar, provides));
+  EXPECT_FALSE(Dependency("baz").SatisfiedBy(bar, {}));
+}
+
 }  // namespace
@@ -2,6 +2,8 @@
 #include "auracle/format.hh"
 
 #include <print>
+#include <span>
+#include <string>
 #include <string_view>
 
 #include "absl/time/time.h"
@@ -65,17 +67,16 @@ struct formatter<absl::Time> {
   std::string tm_format;
 };
 
-// Specialization for formatting vectors of things with an optional custom
-// delimiter.
-template <typename T>
-struct formatter<std::vector<T>> {
+// Formats lists of things with an optional custom delimiter.
+template <typename Container>
+struct list_formatter {
   auto parse(fmt::format_parse_context& ctx) {
     return parse_format_or_default(ctx, "  ", &delimiter_);
   }
 
-  auto format(const std::vector<T>& vec, fmt::format_context& ctx) const {
+  auto format(const Container& list, fmt::format_context& ctx) const {
     std::string_view sep;
-    for (const auto& v : vec) {
+    for (const auto& v : list) {
       fmt::format_to(ctx.out(), "{}{}", sep, v);
       sep = delimiter_;
     }
@@ -87,6 +88,12 @@ struct formatter<std::vector<T>> {
   std::string delimiter_;
 };
 
+template <typename T>
+struct formatter<std::vector<T>> : list_formatter<std::vector<T>> {};
+
+template <typename T>
+struct formatter<std::span<T>> : list_formatter<std::span<T>> {};
+
 template <typename T>
 struct formatter<Field<T>> : formatter<std::string_view> {
   auto format(const Field<T>& f, fmt::format_context& ctx) const {
@@ -108,12 +115,18 @@ FMT_END_NAMESPACE
 
 namespace format {
 
-void NameOnly(const aur::Package& package) {
+namespace {
+
+// Package and RpcPackageView name their fields alike, so either can be printed
+// by the same code.
+template <typename PackageT>
+void PrintNameOnly(const PackageT& package) {
   fmt::print("{}\n", terminal::Bold(package.name));
 }
 
-void Short(const aur::Package& package,
-           const std::optional<auracle::Pacman::Package>& local_package) {
+template <typename PackageT>
+void PrintShort(const PackageT& package,
+                const std::optional<auracle::Pacman::Package>& local_package) {
   namespace t = terminal;
 
   const auto& l = local_package;
@@ -124,8 +137,9 @@ void Short(const aur::Package& package,
   std::string installed_package;
   if (l) {
     const auto local_ver_color =
-        auracle::Pacman::Vercmp(l->pkgver, p.version) < 0 ? &t::BoldRed
-                                                          : &t::BoldGreen;
+        auracle::Pacman::Vercmp(l->pkgver, std::string(p.version)) < 0
+            ? &t::BoldRed
+            : &t::BoldGreen;
     installed_package =
         fmt::format("[installed: {}]", local_ver_color(l->pkgver));
   }
@@ -135,8 +149,9 @@ void Short(const aur::Package& package,
              installed_package, p.description);
 }
 
-void Long(const aur::Package& package,
-          const std::optional<auracle::Pacman::Package>& local_package) {
+template <typename PackageT>
+void PrintLong(const PackageT& package,
+               const std::optional<auracle::Pacman::Package>& local_package) {
   namespace t = terminal;
 
   const auto& l = local_package;
@@ -148,8 +163,9 @@ void Long(const aur::Package& package,
   std::string installed_package;
   if (l) {
     const auto local_ver_color =
-        auracle::Pacman::Vercmp(l->pkgver, p.version) < 0 ? &t::BoldRed
-                                                          : &t::BoldGreen;
+        auracle::Pacman::Vercmp(l->pkgver, std::string(p.version)) < 0
+            ? &t::BoldRed
+            : &t::BoldGreen;
     installed_package =
         fmt::format(" [installed: {}]", local_ver_color(l->pkgver));
   }
@@ -163,9 +179,10 @@ void Long(const aur::Package& package,
   }
 
   fmt::print("{}", Field("URL", t::BoldCyan(p.upstream_url)));
-  fmt::print(
-      "{}", Field("AUR Page",
-                  t::BoldCyan("https://aur.archlinux.org/packages/" + p.name)));
+  fmt::print("{}", Field("AUR Page",
+                         t::BoldCyan(fmt::format(
+                             "https://aur.archlinux.org/packages/{}",
+                             p.name))));
   fmt::print("{}", Field("Keywords", p.keywords));
   fmt::print("{}", Field("Groups", p.groups));
   fmt::print("{}", Field("Depends On", p.depends));
@@ -191,17 +208,9 @@ void Long(const aur::Package& package,
   fmt::print("\n");
 }
 
-void Update(const auracle::Pacman::Package& from, const aur::Package& to) {
-  namespace t = terminal;
-
-  fmt::print("{} {} -> {}\n", t::Bold(from.pkgname), t::BoldRed(from.pkgver),
-             t::BoldGreen(to.version));
-}
-
-namespace {
-
+template <typename PackageT>
 void FormatCustomTo(std::string& out, std::string_view format,
-                    const aur::Package& package) {
+                    const PackageT& package) {
   fmt::dynamic_format_arg_store<fmt::format_context> store;
 
   store.push_back(fmt::arg("name", package.name));
@@ -231,14 +240,54 @@ void FormatCustomTo(std::string& out, std::string_view format,
   fmt::vformat_to(std::back_inserter(out), format, store);
 }
 
-}  // namespace
-
-void Custom(const std::string_view format, const aur::Package& package) {
+template <typename PackageT>
+void PrintCustom(std::string_view format, const PackageT& package) {
   std::string out;
   FormatCustomTo(out, format, package);
   std::println("{}", out);
 }
 
+}  // namespace
+
+void NameOnly(const aur::Package& package) { PrintNameOnly(package); }
+
+void NameOnly(const aur::RpcPackageView& package) { PrintNameOnly(package); }
+
+void Short(const aur::Package& package,
+           const std::optional<auracle::Pacman::Package>& local_package) {
+  PrintShort(package, local_package);
+}
+
+void Short(const aur::RpcPackageView& package,
+           const std::optional<auracle::Pacman::Package>& local_package) {
+  PrintShort(package, local_package);
+}
+
+void Long(const aur::Package& package,
+          const std::optional<auracle::Pacman::Package>& local_package) {
+  PrintLong(package, local_package);
+}
+
+void Long(const aur::RpcPackageView& package,
+          const std::optional<auracle::Pacman::Package>& local_package) {
+  PrintLong(package, local_package);
+}
+
+void Update(const auracle::Pacman::Package& from, const aur::Package& to) {
+  namespace t = terminal;
+
+  fmt::print("{} {} -> {}\n", t::Bold(from.pkgname), t::BoldRed(from.pkgver),
+             t::BoldGreen(to.version));
+}
+
+void Custom(const std::string_view format, const aur::Package& package) {
+  PrintCustom(format, package);
+}
+
+void Custom(const std::string_view format, const aur::RpcPackageView& package) {
+  PrintCustom(format, package);
+}
+
 absl::Status Validate(std::string_view format) {
   try {
     std::string out;
@@ -6,17 +6,24 @@
 
 #include "absl/status/status.h"
 #include "aur/package.hh"
+#include "aur/response_view.hh"
 #include "auracle/pacman.hh"
 
 namespace format {
 
 void NameOnly(const aur::Package& package);
+void NameOnly(const aur::RpcPackageView& package);
 void Update(const auracle::Pacman::Package& from, const aur::Package& to);
 void Short(const aur::Package& package,
            const std::optional<auracle::Pacman::Package>& local_package);
+void Short(const aur::RpcPackageView& package,
+           const std::optional<auracle::Pacman::Package>& local_package);
 void Long(const aur::Package& package,
           const std::optional<auracle::Pacman::Package>& local_package);
+void Long(const aur::RpcPackageView& package,
+          const std::optional<auracle::Pacman::Package>& local_package);
 void Custom(std::string_view format, const aur::Package& package);
+void Custom(std::string_view format, const aur::RpcPackageView& package);
 
 absl::Status Validate(std::string_view format);
 
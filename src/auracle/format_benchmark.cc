@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+#include "auracle/format.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+#include "aur/package.hh"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// Sends anything written to stdout to /dev/null for the lifetime of the object,
+// so that the cost of formatting isn't dominated by the terminal.
+class ScopedStdoutDiscarder {
+ public:
+  ScopedStdoutDiscarder() : saved_(dup(STDOUT_FILENO)) {
+    std::fflush(stdout);
+    const int null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+  }
+
+  ~ScopedStdoutDiscarder() {
+    std::fflush(stdout);
+    dup2(saved_, STDOUT_FILENO);
+    close(saved_);
+  }
+
+  ScopedStdoutDiscarder(const ScopedStdoutDiscarder&) = delete;
+  ScopedStdoutDiscarder& operator=(const ScopedStdoutDiscarder&) = delete;
+
+ private:
+  int saved_;
+};
+
+aur::Package MakePackage() {
+  aur::Package p;
+  p.name = "auracle-git";
+  p.version = "r74.82e863f-1";
+  p.description = "A flexible client for the AUR";
+  p.maintainer = "falconindy";
+  p.votes = 15;
+  p.popularity = 0.095498;
+  p.submitted = absl::FromUnixSeconds(1499013608);
+  p.modified = absl::FromUnixSeconds(1534000474);
+  p.depends = {"pacman", "libarchive.so", "libcurl.so", "systemd-libs"};
+  p.makedepends = {"meson", "git", "nlohmann-json"};
+  p.conflicts = {"auracle"};
+  p.provides = {"auracle"};
+  return p;
+}
+
+void BM_FormatCustom(benchmark::State& state, std::string_view format) {
+  const aur::Package package = MakePackage();
+  ScopedStdoutDiscarder discard;
+
+  for (auto _ : state) {
+    format::Custom(format, package);
+  }
+}
+BENCHMARK_CAPTURE(BM_FormatCustom, string, "{name} {version}");
+BENCHMARK_CAPTURE(BM_FormatCustom, float, "{popularity:.2f} {votes}");
+BENCHMARK_CAPTURE(BM_FormatCustom, datetime, "{submitted:%s} {modified}");
+BENCHMARK_CAPTURE(BM_FormatCustom, list, "{depends:, } {makedepends}");
+BENCHMARK_CAPTURE(BM_FormatCustom, mixed,
+                  "{name} {version} {maintainer} {votes} {popularity:.2f} "
+                  "{modified} {depends} {description}");
+
+}  // namespace
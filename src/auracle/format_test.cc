@@ -5,6 +5,7 @@
 #include <sstream>
 
 #include "aur/package.hh"
+#include "aur/response_view.hh"
 #include "gtest/gtest.h"
 
 class ScopedStdoutCapturer {
@@ -98,3 +99,23 @@ TEST(FormatTest, ListFormat) {
     EXPECT_EQ(capture.GetCapturedOutput(), "auracle:,,cower:,,cower-git\n");
   }
 }
+
+TEST(FormatTest, FormatsViewsLikePackages) {
+  auto response = aur::RpcResponseView::FromPackages({MakePackage()});
+  const auto& view = response.packages[0];
+
+  for (const auto* f :
+       {"{name} -> {version}", "{popularity:.2f}", "{submitted:%s}",
+        "{conflicts}", "{conflicts::,,}", "{depends}"}) {
+    std::string want;
+    {
+      ScopedStdoutCapturer capture;
+      format::Custom(f, MakePackage());
+      want = capture.GetCapturedOutput();
+    }
+
+    ScopedStdoutCapturer capture;
+    format::Custom(f, view);
+    EXPECT_EQ(capture.GetCapturedOutput(), want) << f;
+  }
+}
@@ -1,137 +1,334 @@
 // SPDX-License-Identifier: MIT
 #include "auracle/package_cache.hh"
 
-#include <print>
+#include <algorithm>
 
 #include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_set.h"
 #include "auracle/dependency.hh"
 
 namespace auracle {
 
+namespace {
+
+constexpr DependencyKind kDependencyKinds[] = {
+    DependencyKind::Depend,
+    DependencyKind::MakeDepend,
+    DependencyKind::CheckDepend,
+};
+
+}  // namespace
+
+int PackageCache::InternName(const std::string& name) {
+  const auto [iter, inserted] =
+      name_ids_.try_emplace(name, package_by_name_.size());
+  if (inserted) {
+    package_by_name_.push_back(-1);
+    providers_by_name_.emplace_back();
+  }
+  return iter->second;
+}
+
+int PackageCache::FindName(const std::string& name) const {
+  const auto iter = name_ids_.find(name);
+  return iter == name_ids_.end() ? kNoName : iter->second;
+}
+
 std::pair<const aur::Package*, bool> PackageCache::AddPackage(
     aur::Package package) {
-  const auto iter = absl::c_find(packages_, package);
-  if (iter != packages_.end()) {
-    return {&*iter, false};
+  const int idx = packages_.size();
+  const auto [iter, inserted] = index_by_id_.try_emplace(
+      std::make_pair(package.package_id, package.pkgbase_id), idx);
+  if (!inserted) {
+    return {&packages_[iter->second], false};
   }
 
   const auto& p = packages_.emplace_back(std::move(package));
-  int idx = packages_.size() - 1;
   index_by_pkgbase_.emplace(p.pkgbase, idx);
-  index_by_pkgname_.emplace(p.name, idx);
 
-  for (const auto& provide : p.provides) {
-    index_by_provide_[Dependency(provide).name()].push_back(idx);
+  auto& node = nodes_.emplace_back();
+  node.name = InternName(p.name);
+  if (package_by_name_[node.name] == -1) {
+    package_by_name_[node.name] = idx;
   }
 
+  for (auto kind : kDependencyKinds) {
+    node.dependencies[static_cast<int>(kind)] = dependencies_.size();
+    for (const auto& depstring : GetDependenciesByKind(&p, kind)) {
+      Dependency dep(depstring);
+      const int name = InternName(dep.name());
+      dependencies_.emplace_back(name, std::move(dep));
+    }
+  }
+  node.dependencies.back() = dependencies_.size();
+
+  node.provides_begin = provides_.size();
+  for (const auto& depstring : p.provides) {
+    const auto& provide = provides_.emplace_back(depstring);
+    providers_by_name_[InternName(provide.name())].push_back(idx);
+  }
+  node.provides_end = provides_.size();
+
   return {&p, true};
 }
 
-const aur::Package* PackageCache::LookupByIndex(const PackageIndex& index,
-                                                const std::string& item) const {
-  const auto iter = index.find(item);
-  return iter == index.end() ? nullptr : &packages_[iter->second];
+std::vector<std::pair<const aur::Package*, bool>> PackageCache::AddPackages(
+    std::vector<aur::Package>&& packages) {
+  // Grow geometrically, so that many small batches don't each reallocate.
+  const size_t needed = packages_.size() + packages.size();
+  if (needed > packages_.capacity()) {
+    packages_.reserve(std::max(needed, 2 * packages_.capacity()));
+  }
+  nodes_.reserve(packages_.capacity());
+  index_by_id_.reserve(needed);
+  index_by_pkgbase_.reserve(needed);
+
+  std::vector<std::pair<const aur::Package*, bool>> results;
+  results.reserve(packages.size());
+  for (auto& package : packages) {
+    results.push_back(AddPackage(std::move(package)));
+  }
+  packages.clear();
+
+  return results;
+}
+
+std::vector<std::pair<const aur::Package*, bool>> PackageCache::AddPackages(
+    std::span<const aur::RpcPackageView> packages) {
+  std::vector<aur::Package> added;
+  std::vector<int> cached(packages.size(), -1);
+  for (size_t i = 0; i < packages.size(); ++i) {
+    const auto iter = index_by_id_.find(
+        std::make_pair(packages[i].package_id, packages[i].pkgbase_id));
+    if (iter != index_by_id_.end()) {
+      cached[i] = iter->second;
+    } else {
+      added.push_back(packages[i].ToPackage());
+    }
+  }
+
+  // Duplicates within |packages| are caught here, as by AddPackage.
+  auto added_results = AddPackages(std::move(added));
+
+  std::vector<std::pair<const aur::Package*, bool>> results;
+  results.reserve(packages.size());
+  auto next_added = added_results.begin();
+  for (const int idx : cached) {
+    results.push_back(idx >= 0 ? std::make_pair(&packages_[idx], false)
+                               : *next_added++);
+  }
+
+  return results;
+}
+
+std::span<const PackageCache::ParsedDependency>
+PackageCache::GetParsedDependencies(int idx, DependencyKind kind) const {
+  const auto& offsets = nodes_[idx].dependencies;
+  const int k = static_cast<int>(kind);
+  return std::span(dependencies_).subspan(offsets[k],
+                                          offsets[k + 1] - offsets[k]);
+}
+
+std::span<const Dependency> PackageCache::GetProvides(int idx) const {
+  const auto& node = nodes_[idx];
+  return std::span(provides_).subspan(node.provides_begin,
+                                      node.provides_end - node.provides_begin);
 }
 
 const aur::Package* PackageCache::LookupByPkgname(
     const std::string& pkgname) const {
-  return LookupByIndex(index_by_pkgname_, pkgname);
+  const int name = FindName(pkgname);
+  if (name == kNoName || package_by_name_[name] == -1) {
+    return nullptr;
+  }
+  return &packages_[package_by_name_[name]];
 }
 
 const aur::Package* PackageCache::LookupByPkgbase(
     const std::string& pkgbase) const {
-  return LookupByIndex(index_by_pkgbase_, pkgbase);
+  const auto iter = index_by_pkgbase_.find(pkgbase);
+  return iter == index_by_pkgbase_.end() ? nullptr : &packages_[iter->second];
 }
 
 std::vector<const aur::Package*> PackageCache::FindDependencySatisfiers(
     const Dependency& dep) const {
   std::vector<const aur::Package*> satisfiers;
-  if (auto iter = index_by_provide_.find(dep.name());
-      iter != index_by_provide_.end()) {
-    for (const int idx : iter->second) {
-      const auto& package = packages_[idx];
-      if (dep.SatisfiedBy(package)) {
-        satisfiers.push_back(&package);
-      }
+
+  const int name = FindName(dep.name());
+  if (name == kNoName) {
+    return satisfiers;
+  }
+
+  for (const int idx : providers_by_name_[name]) {
+    const auto& package = packages_[idx];
+    if (dep.SatisfiedBy(package, GetProvides(idx))) {
+      satisfiers.push_back(&package);
     }
   }
 
   return satisfiers;
 }
 
-class DependencyPath : public std::vector<std::string> {
- public:
-  class Step {
-   public:
-    Step(DependencyPath& dependency_path, std::string step)
-        : dependency_path_(dependency_path) {
-      MaybeReportCycle(step);
+void PackageCache::WalkDependencies(
+    const std::string& name, WalkDependenciesFn cb,
+    const absl::btree_set<DependencyKind>& dependency_kinds) const {
+  const std::vector<DependencyKind> kinds(dependency_kinds.begin(),
+                                          dependency_kinds.end());
+
+  // Indexed by name ID. A name that's never been seen can't have any
+  // dependencies of its own, so it needn't be tracked.
+  std::vector<bool> visited(package_by_name_.size());
 
-      dependency_path_.push_back(step);
-    }
+  std::vector<std::string> dependency_path;
 
-    ~Step() { dependency_path_.pop_back(); }
+  struct Frame {
+    const Dependency* dep;
+    // The index of the package, or -1 if it isn't in the cache.
+    int idx;
+    // The next dependency to visit, as an offset into kinds and then into
+    // the dependencies of that kind.
+    size_t kind = 0;
+    size_t next = 0;
+  };
+  std::vector<Frame> stack;
 
-   private:
-    void MaybeReportCycle(const std::string& step) const {
-      auto cycle_start = absl::c_find(dependency_path_, step);
-      if (cycle_start == dependency_path_.end()) {
+  const auto visit = [&](int name, const Dependency& dep) {
+    if (name != kNoName) {
+      if (visited[name]) {
         return;
       }
+      visited[name] = true;
+    }
 
-      std::print(stderr, "warning: found dependency cycle:");
+    dependency_path.push_back(dep.name());
+    stack.push_back({
+        .dep = &dep,
+        .idx = name == kNoName ? -1 : package_by_name_[name],
+    });
+  };
 
-      // Print the path leading up to the start of the cycle
-      auto iter = dependency_path_.cbegin();
-      while (iter != cycle_start) {
-        std::print(stderr, " {} ->", *iter);
-        ++iter;
-      }
+  const Dependency root(name);
+  visit(FindName(root.name()), root);
 
-      // Print the cycle itself, wrapped in brackets
-      std::print(stderr, " [ {}", *iter);
-      ++iter;
-      while (iter != dependency_path_.cend()) {
-        std::print(stderr, " -> {}", *iter);
-        ++iter;
-      }
+  while (!stack.empty()) {
+    auto& frame = stack.back();
 
-      std::println(stderr, " -> {} ]", *cycle_start);
+    if (frame.idx != -1 && frame.kind < kinds.size()) {
+      const auto deps = GetParsedDependencies(frame.idx, kinds[frame.kind]);
+      if (frame.next < deps.size()) {
+        // This may grow the stack, invalidating |frame|.
+        const auto& d = deps[frame.next++];
+        visit(d.name, d.dependency);
+      } else {
+        ++frame.kind;
+        frame.next = 0;
+      }
+      continue;
     }
 
-    DependencyPath& dependency_path_;
-  };
-};
+    cb(*frame.dep, frame.idx == -1 ? nullptr : &packages_[frame.idx],
+       dependency_path);
 
-void PackageCache::WalkDependencies(
-    const std::string& name, WalkDependenciesFn cb,
+    dependency_path.pop_back();
+    stack.pop_back();
+  }
+}
+
+std::vector<std::vector<const aur::Package*>>
+PackageCache::FindDependencyCycles(
+    const std::vector<std::string>& names,
     const absl::btree_set<DependencyKind>& dependency_kinds) const {
-  absl::flat_hash_set<std::string> visited;
-  DependencyPath dependency_path;
+  const std::vector<DependencyKind> kinds(dependency_kinds.begin(),
+                                          dependency_kinds.end());
+
+  // Tarjan's algorithm, over the packages in the cache. Indexed by package.
+  std::vector<int> index(packages_.size(), -1);
+  std::vector<int> lowlink(packages_.size());
+  std::vector<bool> on_stack(packages_.size());
+  int next_index = 0;
 
-  std::function<void(const Dependency&)> walk;
-  walk = [&](const Dependency& dep) {
-    DependencyPath::Step step(dependency_path, dep.name());
+  std::vector<int> stack;
+  std::vector<std::vector<const aur::Package*>> cycles;
 
-    if (!visited.insert(dep.name()).second) {
-      return;
+  struct Frame {
+    int idx;
+    // The next dependency to visit, as in WalkDependencies.
+    size_t kind = 0;
+    size_t next = 0;
+    bool depends_on_self = false;
+  };
+  std::vector<Frame> frames;
+
+  const auto visit = [&](int idx) {
+    index[idx] = lowlink[idx] = next_index++;
+    stack.push_back(idx);
+    on_stack[idx] = true;
+    frames.push_back({.idx = idx});
+  };
+
+  for (const auto& name : names) {
+    const int name_id = FindName(Dependency(name).name());
+    if (name_id == kNoName || package_by_name_[name_id] == -1 ||
+        index[package_by_name_[name_id]] != -1) {
+      continue;
     }
 
-    const auto* pkg = LookupByPkgname(dep.name());
-    if (pkg != nullptr) {
-      for (auto kind : dependency_kinds) {
-        const auto& deplist = GetDependenciesByKind(pkg, kind);
-        for (const auto& d : deplist) {
-          walk(Dependency(d));
+    visit(package_by_name_[name_id]);
+    while (!frames.empty()) {
+      auto& frame = frames.back();
+      const int idx = frame.idx;
+
+      if (frame.kind < kinds.size()) {
+        const auto deps = GetParsedDependencies(idx, kinds[frame.kind]);
+        if (frame.next == deps.size()) {
+          ++frame.kind;
+          frame.next = 0;
+          continue;
+        }
+
+        const int dep = package_by_name_[deps[frame.next++].name];
+        if (dep == -1) {
+          continue;
+        }
+
+        if (dep == idx) {
+          frame.depends_on_self = true;
+        } else if (index[dep] == -1) {
+          // This grows the stack, invalidating |frame|.
+          visit(dep);
+        } else if (on_stack[dep]) {
+          lowlink[idx] = std::min(lowlink[idx], index[dep]);
         }
+        continue;
       }
-    }
 
-    cb(dep, pkg, dependency_path);
-  };
+      // Every dependency has been visited. If nothing reachable from here
+      // leads back to an earlier package, this is the root of a component.
+      if (lowlink[idx] == index[idx]) {
+        std::vector<const aur::Package*> component;
+        int member;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          on_stack[member] = false;
+          component.push_back(&packages_[member]);
+        } while (member != idx);
+
+        if (component.size() > 1 || frame.depends_on_self) {
+          // Members were popped in the reverse of the order they were found.
+          absl::c_reverse(component);
+          cycles.push_back(std::move(component));
+        }
+      }
+
+      frames.pop_back();
+      if (!frames.empty()) {
+        const int parent = frames.back().idx;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[idx]);
+      }
+    }
+  }
 
-  walk(Dependency(name));
+  return cycles;
 }
 
 }  // namespace auracle
@@ -2,13 +2,17 @@
 #ifndef PACKAGE_AURACLE_CACHE_HH_
 #define PACKAGE_AURACLE_CACHE_HH_
 
+#include <array>
 #include <functional>
 #include <set>
+#include <span>
 #include <utility>
+#include <vector>
 
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "aur/package.hh"
+#include "aur/response_view.hh"
 #include "auracle/dependency.hh"
 #include "auracle/dependency_kind.hh"
 
@@ -25,8 +29,21 @@ class PackageCache {
   PackageCache(PackageCache&&) = default;
   PackageCache& operator=(PackageCache&&) = default;
 
+  // Adds |package| to the cache, unless a package with the same IDs is already
+  // present. Returns the cached package, and whether or not it was added.
   std::pair<const aur::Package*, bool> AddPackage(aur::Package package);
 
+  // Adds each of |packages| as if by AddPackage, returning the results in the
+  // same order. Storage is reserved up front, so the returned pointers all
+  // remain valid until the next time the cache is modified.
+  std::vector<std::pair<const aur::Package*, bool>> AddPackages(
+      std::vector<aur::Package>&& packages);
+
+  // As AddPackages, but copies out of the views only those packages which
+  // aren't already cached.
+  std::vector<std::pair<const aur::Package*, bool>> AddPackages(
+      std::span<const aur::RpcPackageView> packages);
+
   const aur::Package* LookupByPkgname(const std::string& pkgname) const;
   const aur::Package* LookupByPkgbase(const std::string& pkgbase) const;
   std::vector<const aur::Package*> FindDependencySatisfiers(
@@ -43,20 +60,70 @@ class PackageCache {
       const std::string& name, WalkDependenciesFn cb,
       const absl::btree_set<DependencyKind>& dependency_kinds) const;
 
+  // Finds the strongly connected components of the dependency graph reachable
+  // from the named packages which contain a cycle. Each component is a set of
+  // packages which can only be built together. Members of a component are
+  // ordered by their discovery from |names|.
+  std::vector<std::vector<const aur::Package*>> FindDependencyCycles(
+      const std::vector<std::string>& names,
+      const absl::btree_set<DependencyKind>& dependency_kinds) const;
+
  private:
-  std::vector<aur::Package> packages_;
+  // A dependency, parsed once as its package is added to the cache, along with
+  // the interned ID of its name.
+  struct ParsedDependency {
+    int name;
+    Dependency dependency;
+  };
+
+  // The parsed form of a package, stored at the same index as the package.
+  struct PackageNode {
+    int name;
+
+    // Offsets into dependencies_: dependencies of kind K are found in the
+    // range [dependencies[K], dependencies[K + 1]).
+    std::array<int, 4> dependencies;
+
+    // Offsets into provides_.
+    int provides_begin;
+    int provides_end;
+  };
 
-  using PackageIndex = absl::flat_hash_map<std::string, int>;
+  static constexpr int kNoName = -1;
 
-  const aur::Package* LookupByIndex(const PackageIndex& index,
-                                    const std::string& item) const;
+  // Returns the ID of |name|, assigning one if it's never been seen before.
+  int InternName(const std::string& name);
+
+  // Returns the ID of |name|, or kNoName if it's never been seen before.
+  int FindName(const std::string& name) const;
+
+  std::span<const ParsedDependency> GetParsedDependencies(
+      int idx, DependencyKind kind) const;
+  std::span<const Dependency> GetProvides(int idx) const;
+
+  std::vector<aur::Package> packages_;
+  std::vector<PackageNode> nodes_;
+  std::vector<ParsedDependency> dependencies_;
+  std::vector<Dependency> provides_;
 
   // We store integer indicies into the packages_ vector above rather than
   // pointers to the packages. This allows the vector to resize and not
-  // invalidate our index maps.
-  PackageIndex index_by_pkgname_;
-  PackageIndex index_by_pkgbase_;
-  absl::flat_hash_map<std::string, std::vector<int>> index_by_provide_;
+  // invalidate our indices.
+  absl::flat_hash_map<std::string, int> index_by_pkgbase_;
+
+  // Keyed on the package_id and pkgbase_id, which is what defines package
+  // equality.
+  absl::flat_hash_map<std::pair<int, int>, int> index_by_id_;
+
+  // Every package name, dependency name and provide name that we've seen, and
+  // the IDs they've been interned as. The vectors below are indexed by ID.
+  absl::flat_hash_map<std::string, int> name_ids_;
+
+  // The package with each name, or -1 if no such package has been added.
+  std::vector<int> package_by_name_;
+
+  // The packages which provide each name.
+  std::vector<std::vector<int>> providers_by_name_;
 };
 
 }  // namespace auracle
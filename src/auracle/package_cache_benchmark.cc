@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: MIT
+#include "auracle/package_cache.hh"
+
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "aur/package.hh"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// Builds an acyclic dependency graph of |count| packages. Each package depends
+// on the next two, and on one further away, so that a walk from the first
+// package reaches every other one, and most of them more than once.
+std::vector<aur::Package> MakePackageGraph(int count) {
+  std::vector<aur::Package> packages(count);
+  for (int i = 0; i < count; ++i) {
+    auto& p = packages[i];
+    p.package_id = i + 1;
+    p.pkgbase_id = i + 1;
+    p.name = absl::StrCat("package-", i);
+    p.pkgbase = p.name;
+    p.version = "1.0.0-1";
+    p.provides = {absl::StrCat("virtual-", i, "=1.0.0")};
+
+    for (int dep : {i + 1, i + 2, 2 * i + 1}) {
+      if (dep < count) {
+        p.depends.push_back(absl::StrCat("package-", dep, ">=1.0"));
+      }
+    }
+    if (i + 3 < count) {
+      p.makedepends.push_back(absl::StrCat("virtual-", i + 3));
+    }
+  }
+  return packages;
+}
+
+void BM_PackageCacheAddPackage(benchmark::State& state) {
+  const auto packages = MakePackageGraph(state.range(0));
+
+  for (auto _ : state) {
+    auracle::PackageCache cache;
+    for (const auto& package : packages) {
+      benchmark::DoNotOptimize(cache.AddPackage(package));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * packages.size());
+}
+BENCHMARK(BM_PackageCacheAddPackage)->Arg(1000)->Arg(10000);
+
+void BM_PackageCacheAddPackages(benchmark::State& state) {
+  const auto packages = MakePackageGraph(state.range(0));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto batch = packages;
+    state.ResumeTiming();
+
+    auracle::PackageCache cache;
+    benchmark::DoNotOptimize(cache.AddPackages(std::move(batch)));
+  }
+
+  state.SetItemsProcessed(state.iterations() * packages.size());
+}
+BENCHMARK(BM_PackageCacheAddPackages)->Arg(1000)->Arg(10000);
+
+void BM_PackageCacheWalkDependencies(benchmark::State& state) {
+  auracle::PackageCache cache;
+  for (auto& package : MakePackageGraph(state.range(0))) {
+    cache.AddPackage(std::move(package));
+  }
+
+  const absl::btree_set<auracle::DependencyKind> kinds = {
+      auracle::DependencyKind::Depend,
+      auracle::DependencyKind::MakeDepend,
+  };
+
+  for (auto _ : state) {
+    int visited = 0;
+    cache.WalkDependencies(
+        "package-0",
+        [&](const auracle::Dependency&, const aur::Package* package,
+            const std::vector<std::string>&) { visited += package != nullptr; },
+        kinds);
+    benchmark::DoNotOptimize(visited);
+  }
+
+  state.SetItemsProcessed(state.iterations() * cache.size());
+}
+BENCHMARK(BM_PackageCacheWalkDependencies)->Arg(1000)->Arg(10000);
+
+void BM_PackageCacheFindDependencySatisfiers(benchmark::State& state) {
+  auracle::PackageCache cache;
+  for (auto& package : MakePackageGraph(10000)) {
+    cache.AddPackage(std::move(package));
+  }
+
+  const auracle::Dependency dep("virtual-5000>=1.0");
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.FindDependencySatisfiers(dep));
+  }
+}
+BENCHMARK(BM_PackageCacheFindDependencySatisfiers);
+
+}  // namespace
@@ -1,7 +1,11 @@
 // SPDX-License-Identifier: MIT
 #include "auracle/package_cache.hh"
 
+#include <tuple>
+
+#include "absl/strings/str_cat.h"
 #include "aur/package.hh"
+#include "aur/response_view.hh"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -35,6 +39,75 @@ TEST(PackageCacheTest, AddsPackages) {
   }
 }
 
+TEST(PackageCacheTest, AddsPackagesInBulk) {
+  auracle::PackageCache cache;
+
+  aur::Package auracle;
+  auracle.package_id = 534056;
+  auracle.name = "auracle-git";
+  auracle.pkgbase_id = 123768;
+  auracle.pkgbase = "auracle-git";
+  cache.AddPackage(auracle);
+
+  std::vector<aur::Package> packages(3);
+  packages[0].package_id = 534055;
+  packages[0].name = "pkgfile-git";
+  packages[0].pkgbase_id = 60915;
+  packages[0].pkgbase = "pkgfile-git";
+  packages[1] = auracle;
+  packages[2] = packages[0];
+
+  const auto results = cache.AddPackages(std::move(packages));
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(cache.size(), 2);
+
+  EXPECT_TRUE(results[0].second);
+  EXPECT_EQ(results[0].first->name, "pkgfile-git");
+  EXPECT_EQ(results[0].first, cache.LookupByPkgname("pkgfile-git"));
+
+  EXPECT_FALSE(results[1].second);
+  EXPECT_EQ(results[1].first, cache.LookupByPkgname("auracle-git"));
+
+  EXPECT_FALSE(results[2].second);
+  EXPECT_EQ(results[2].first, results[0].first);
+}
+
+TEST(PackageCacheTest, AddsPackagesFromViews) {
+  auracle::PackageCache cache;
+
+  aur::Package auracle;
+  auracle.package_id = 534056;
+  auracle.name = "auracle-git";
+  auracle.pkgbase_id = 123768;
+  auracle.pkgbase = "auracle-git";
+  cache.AddPackage(auracle);
+
+  std::vector<aur::Package> packages(3);
+  packages[0] = auracle;
+  packages[1].package_id = 534055;
+  packages[1].name = "pkgfile-git";
+  packages[1].pkgbase_id = 60915;
+  packages[1].pkgbase = "pkgfile-git";
+  packages[1].depends = {"libarchive", "curl"};
+  packages[2] = packages[1];
+
+  const auto results = cache.AddPackages(
+      aur::RpcResponseView::FromPackages(std::move(packages)).packages);
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(cache.size(), 2);
+
+  EXPECT_FALSE(results[0].second);
+  EXPECT_EQ(results[0].first, cache.LookupByPkgname("auracle-git"));
+
+  // The cache keeps a copy of its own once the views are gone.
+  EXPECT_TRUE(results[1].second);
+  EXPECT_EQ(results[1].first, cache.LookupByPkgname("pkgfile-git"));
+  EXPECT_THAT(results[1].first->depends, ElementsAre("libarchive", "curl"));
+
+  EXPECT_FALSE(results[2].second);
+  EXPECT_EQ(results[2].first, results[1].first);
+}
+
 TEST(PackageCacheTest, LooksUpPackages) {
   auracle::PackageCache cache;
 
@@ -197,6 +270,93 @@ TEST(PackageCacheTest, WalkDependenciesWithLimitedDeps) {
   aur_packages.clear();
 }
 
+TEST(PackageCacheTest, WalkDependenciesTerminatesOnCycles) {
+  auracle::PackageCache cache;
+  for (const auto& [id, name, dep] : {std::tuple{1, "a", "b"},
+                                      std::tuple{2, "b", "c"},
+                                      std::tuple{3, "c", "b"}}) {
+    aur::Package package;
+    package.package_id = id;
+    package.name = name;
+    package.pkgbase_id = id;
+    package.pkgbase = name;
+    package.depends = {dep};
+    cache.AddPackage(package);
+  }
+
+  std::vector<std::string> walked_packages;
+  cache.WalkDependencies(
+      "a",
+      [&](const Dependency& dep, const aur::Package*,
+          const std::vector<std::string>& dependency_path) {
+        walked_packages.push_back(dep.name());
+        EXPECT_EQ(dependency_path.back(), dep.name());
+      },
+      {auracle::DependencyKind::Depend});
+
+  EXPECT_THAT(walked_packages, ElementsAre("c", "b", "a"));
+}
+
+TEST(PackageCacheTest, FindsDependencyCycles) {
+  auracle::PackageCache cache;
+  for (const auto& [id, name, deps] :
+       {std::tuple<int, const char*, std::vector<std::string>>{1, "a", {"b"}},
+        {2, "b", {"c", "d"}},
+        {3, "c", {"b"}},
+        {4, "d", {"e", "libc"}},
+        {5, "e", {"e"}},
+        {6, "f", {"d"}}}) {
+    aur::Package package;
+    package.package_id = id;
+    package.name = name;
+    package.pkgbase_id = id;
+    package.pkgbase = name;
+    package.depends = deps;
+    cache.AddPackage(package);
+  }
+
+  const auto cycles =
+      cache.FindDependencyCycles({"a", "f"}, {auracle::DependencyKind::Depend});
+  ASSERT_EQ(cycles.size(), 2);
+  EXPECT_THAT(cycles[0], ElementsAre(Field(&aur::Package::name, "e")));
+  EXPECT_THAT(cycles[1], ElementsAre(Field(&aur::Package::name, "b"),
+                                     Field(&aur::Package::name, "c")));
+
+  EXPECT_THAT(
+      cache.FindDependencyCycles({"d"}, {auracle::DependencyKind::MakeDepend}),
+      testing::IsEmpty());
+}
+
+TEST(PackageCacheTest, WalkDependenciesOfDeepGraphs) {
+  constexpr int kDepth = 100000;
+
+  auracle::PackageCache cache;
+  for (int i = 0; i < kDepth; ++i) {
+    aur::Package package;
+    package.package_id = i;
+    package.name = absl::StrCat("package-", i);
+    package.pkgbase_id = i;
+    package.pkgbase = package.name;
+    package.depends = {absl::StrCat("package-", i + 1)};
+    cache.AddPackage(package);
+  }
+
+  int walked = 0;
+  size_t max_depth = 0;
+  cache.WalkDependencies(
+      "package-0",
+      [&](const Dependency&, const aur::Package*,
+          const std::vector<std::string>& dependency_path) {
+        ++walked;
+        max_depth = std::max(max_depth, dependency_path.size());
+      },
+      {auracle::DependencyKind::Depend});
+
+  // Every package, and the final dependency which isn't in the cache.
+  EXPECT_EQ(walked, kDepth + 1);
+  EXPECT_EQ(max_depth, kDepth + 1);
+}
+
 TEST(PackageCacheTest, FindDependencySatisfiers) {
   auracle::PackageCache cache;
   {
@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: MIT
+#include "auracle/search_fragment.hh"
+
+#include "benchmark/benchmark.h"
+
+namespace {
+
+void BM_GetSearchFragment(benchmark::State& state, std::string_view input) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(auracle::GetSearchFragment(input));
+  }
+}
+BENCHMARK_CAPTURE(BM_GetSearchFragment, literal, "auracle");
+BENCHMARK_CAPTURE(BM_GetSearchFragment, anchored, "^auracle.*-git$");
+BENCHMARK_CAPTURE(BM_GetSearchFragment, brackets,
+                  "[a-z]+lib(foo|bar)[0-9]{2,3}python-.*-bindings?");
+
+}  // namespace
@@ -3,15 +3,18 @@
 
 namespace sort {
 
-template <typename T>
-Sorter MakePackageSorter(T aur::Package::* field, OrderBy order_by) {
+namespace {
+
+template <typename PackageT, typename T>
+std::function<bool(const PackageT&, const PackageT&)> MakeSorter(
+    T PackageT::* field, OrderBy order_by) {
   switch (order_by) {
     case OrderBy::ORDER_ASC:
-      return [=](const aur::Package& a, const aur::Package& b) {
+      return [=](const PackageT& a, const PackageT& b) {
         return (a.*field < b.*field) && !(a.*field > b.*field);
       };
     case OrderBy::ORDER_DESC:
-      return [=](const aur::Package& a, const aur::Package& b) {
+      return [=](const PackageT& a, const PackageT& b) {
         return (a.*field > b.*field) && !(a.*field < b.*field);
       };
   }
@@ -19,20 +22,33 @@ Sorter MakePackageSorter(T aur::Package::* field, OrderBy order_by) {
   return nullptr;
 }
 
-Sorter MakePackageSorter(std::string_view field, OrderBy order_by) {
+// Package and RpcPackageView name their fields alike, so either can be sorted.
+template <typename PackageT>
+std::function<bool(const PackageT&, const PackageT&)> MakeSorter(
+    std::string_view field, OrderBy order_by) {
   if (field == "name") {
-    return MakePackageSorter(&aur::Package::name, order_by);
+    return MakeSorter(&PackageT::name, order_by);
   } else if (field == "popularity") {
-    return MakePackageSorter(&aur::Package::popularity, order_by);
+    return MakeSorter(&PackageT::popularity, order_by);
   } else if (field == "votes") {
-    return MakePackageSorter(&aur::Package::votes, order_by);
+    return MakeSorter(&PackageT::votes, order_by);
   } else if (field == "firstsubmitted") {
-    return MakePackageSorter(&aur::Package::submitted, order_by);
+    return MakeSorter(&PackageT::submitted, order_by);
   } else if (field == "lastmodified") {
-    return MakePackageSorter(&aur::Package::modified, order_by);
+    return MakeSorter(&PackageT::modified, order_by);
   }
 
   return nullptr;
 }
 
+}  // namespace
+
+Sorter MakePackageSorter(std::string_view field, OrderBy order_by) {
+  return MakeSorter<aur::Package>(field, order_by);
+}
+
+ViewSorter MakePackageViewSorter(std::string_view field, OrderBy order_by) {
+  return MakeSorter<aur::RpcPackageView>(field, order_by);
+}
+
 }  // namespace sort
@@ -6,6 +6,7 @@
 #include <string_view>
 
 #include "aur/package.hh"
+#include "aur/response_view.hh"
 
 namespace sort {
 
@@ -16,6 +17,12 @@ using Sorter = std::function<bool(const aur::Package&, const aur::Package&)>;
 // Returns a binary predicate suitable for use with std::sort.
 Sorter MakePackageSorter(std::string_view field, OrderBy order_by);
 
+using ViewSorter =
+    std::function<bool(const aur::RpcPackageView&, const aur::RpcPackageView&)>;
+
+// As MakePackageSorter, but for RpcPackageViews.
+ViewSorter MakePackageViewSorter(std::string_view field, OrderBy order_by);
+
 }  // namespace sort
 
 #endif  // AURACLE_SORT_HH_
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+#include "auracle/sort.hh"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "aur/package.hh"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+std::vector<aur::Package> MakePackages(int count) {
+  std::mt19937 rng(42);
+  std::vector<aur::Package> packages(count);
+  for (auto& p : packages) {
+    p.name = absl::StrCat("package-", rng());
+    p.votes = rng() % 1000;
+    p.popularity = std::uniform_real_distribution<double>(0, 10)(rng);
+    p.submitted = absl::FromUnixSeconds(1000000000 + rng() % 500000000);
+    p.modified = p.submitted + absl::Seconds(rng() % 100000000);
+  }
+  return packages;
+}
+
+void BM_PackageSort(benchmark::State& state, std::string_view field) {
+  const auto packages = MakePackages(state.range(0));
+  const auto sorter =
+      sort::MakePackageSorter(field, sort::OrderBy::ORDER_DESC);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto sorted = packages;
+    state.ResumeTiming();
+
+    std::sort(sorted.begin(), sorted.end(), sorter);
+    benchmark::DoNotOptimize(sorted);
+  }
+
+  state.SetItemsProcessed(state.iterations() * packages.size());
+}
+BENCHMARK_CAPTURE(BM_PackageSort, name, "name")->Arg(10000);
+BENCHMARK_CAPTURE(BM_PackageSort, votes, "votes")->Arg(10000);
+BENCHMARK_CAPTURE(BM_PackageSort, popularity, "popularity")->Arg(10000);
+BENCHMARK_CAPTURE(BM_PackageSort, firstsubmitted, "firstsubmitted")
+    ->Arg(10000);
+
+void BM_MakePackageSorter(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        sort::MakePackageSorter("popularity", sort::OrderBy::ORDER_ASC));
+  }
+}
+BENCHMARK(BM_MakePackageSorter);
+
+}  // namespace
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "aur/package.hh"
+#include "aur/response_view.hh"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -16,6 +17,8 @@ TEST(SortOrderTest, RejectsInvalidSortField) {
             sort::MakePackageSorter("invalid", sort::OrderBy::ORDER_ASC));
   EXPECT_EQ(nullptr,
             sort::MakePackageSorter("depends", sort::OrderBy::ORDER_ASC));
+  EXPECT_EQ(nullptr,
+            sort::MakePackageViewSorter("depends", sort::OrderBy::ORDER_ASC));
 }
 
 std::vector<aur::Package> MakePackages() {
@@ -120,3 +123,27 @@ INSTANTIATE_TEST_SUITE_P(BothOrderings, SortOrderTest,
                            }
                            return "UNKNOWN";
                          });
+
+TEST(SortViewTest, SortsViewsLikePackages) {
+  auto response = aur::RpcResponseView::FromPackages(MakePackages());
+
+  for (const auto* field :
+       {"name", "popularity", "votes", "firstsubmitted", "lastmodified"}) {
+    for (const auto order_by :
+         {sort::OrderBy::ORDER_ASC, sort::OrderBy::ORDER_DESC}) {
+      auto packages = MakePackages();
+      std::sort(packages.begin(), packages.end(),
+                sort::MakePackageSorter(field, order_by));
+      auto views = response.packages;
+      std::sort(views.begin(), views.end(),
+                sort::MakePackageViewSorter(field, order_by));
+
+      std::vector<std::string_view> want, got;
+      for (size_t i = 0; i < packages.size(); ++i) {
+        want.push_back(packages[i].name);
+        got.push_back(views[i].name);
+      }
+      EXPECT_EQ(want, got) << field;
+    }
+  }
+}
@@ -5,6 +5,7 @@
 #include <unistd.h>
 
 #include <string>
+#include <string_view>
 
 #include "absl/strings/str_cat.h"
 
@@ -15,9 +16,9 @@ constexpr int kDefaultColumns = 80;
 int g_cached_columns = -1;
 WantColor g_want_color = WantColor::AUTO;
 
-std::string Color(const std::string& s, const char* color) {
+std::string Color(std::string_view s, const char* color) {
   if (g_want_color == WantColor::NO) {
-    return s;
+    return std::string(s);
   }
 
   return absl::StrCat(color, s, "\033[0m");
@@ -25,11 +26,11 @@ std::string Color(const std::string& s, const char* color) {
 
 }  // namespace
 
-std::string Bold(const std::string& s) { return Color(s, "\033[1m"); }
-std::string BoldRed(const std::string& s) { return Color(s, "\033[1;31m"); }
-std::string BoldCyan(const std::string& s) { return Color(s, "\033[1;36m"); }
-std::string BoldGreen(const std::string& s) { return Color(s, "\033[1;32m"); }
-std::string BoldMagenta(const std::string& s) { return Color(s, "\033[1;35m"); }
+std::string Bold(std::string_view s) { return Color(s, "\033[1m"); }
+std::string BoldRed(std::string_view s) { return Color(s, "\033[1;31m"); }
+std::string BoldCyan(std::string_view s) { return Color(s, "\033[1;36m"); }
+std::string BoldGreen(std::string_view s) { return Color(s, "\033[1;32m"); }
+std::string BoldMagenta(std::string_view s) { return Color(s, "\033[1;35m"); }
 
 void Init(WantColor want) {
   if (want == WantColor::AUTO) {
@@ -3,6 +3,7 @@
 #define AURACLE_TERMINAL_HH_
 
 #include <string>
+#include <string_view>
 
 namespace terminal {
 
@@ -16,11 +17,11 @@ void Init(WantColor);
 
 int Columns();
 
-std::string Bold(const std::string& s);
-std::string BoldCyan(const std::string& s);
-std::string BoldGreen(const std::string& s);
-std::string BoldMagenta(const std::string& s);
-std::string BoldRed(const std::string& s);
+std::string Bold(std::string_view s);
+std::string BoldCyan(std::string_view s);
+std::string BoldGreen(std::string_view s);
+std::string BoldMagenta(std::string_view s);
+std::string BoldRed(std::string_view s);
 
 }  // namespace terminal
 
@@ -2,9 +2,15 @@
 #include <getopt.h>
 
 #include <clocale>
+#include <cstdlib>
+#include <fstream>
 #include <print>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
 #include "auracle/auracle.hh"
 #include "auracle/format.hh"
 #include "auracle/sort.hh"
@@ -15,11 +21,47 @@ namespace {
 constexpr std::string_view kAurBaseurl = "https://aur.archlinux.org";
 constexpr std::string_view kPacmanConf = "/etc/pacman.conf";
 
+std::string DefaultMetadataFile() {
+  if (const char* cache_home = getenv("XDG_CACHE_HOME");
+      cache_home != nullptr && *cache_home != '\0') {
+    return absl::StrCat(cache_home, "/auracle/aur-metadata");
+  }
+
+  if (const char* home = getenv("HOME"); home != nullptr && *home != '\0') {
+    return absl::StrCat(home, "/.cache/auracle/aur-metadata");
+  }
+
+  return "";
+}
+
+// Returns where to write request stats as JSON, as requested by
+// AURACLE_STATS=json:PATH, or an empty string.
+std::string StatsJsonPath() {
+  const char* value = getenv("AURACLE_STATS");
+  std::string_view stats = value != nullptr ? value : "";
+  if (!absl::ConsumePrefix(&stats, "json:")) {
+    return "";
+  }
+
+  return std::string(stats);
+}
+
 struct Flags {
   bool ParseFromArgv(int* argc, char*** argv);
 
   std::string baseurl = std::string(kAurBaseurl);
   std::optional<std::string> proxy = std::nullopt;
+  std::optional<std::string> cache_directory = std::nullopt;
+  std::optional<absl::Duration> cache_ttl = std::nullopt;
+  std::optional<int> max_parallel_clones = std::nullopt;
+  std::optional<double> rate_limit = std::nullopt;
+  std::optional<int> max_connections = std::nullopt;
+  std::optional<int> max_streams = std::nullopt;
+  std::optional<absl::Duration> connect_timeout = std::nullopt;
+  std::optional<absl::Duration> keepalive = std::nullopt;
+  std::string metadata_file = DefaultMetadataFile();
+  bool offline = false;
+  bool stats = false;
   std::string pacman_config = std::string(kPacmanConf);
   terminal::WantColor color = terminal::WantColor::AUTO;
 
@@ -46,7 +88,30 @@ struct Flags {
       "recursive operations\n"
       "      --show-file=FILE     File to dump with 'show' command\n"
       "  -C DIR, --chdir=DIR      Change directory to DIR before cloning\n"
+      "      --jobs=N             Run at most N git processes at once\n"
+      "      --depth=N            Clone and update only the last N commits\n"
+      "      --filter=SPEC        Make partial clones, e.g. with blob:none\n"
+      "      --snapshot           Download snapshot tarballs instead of "
+      "cloning\n"
+      "      --waves[=FORMAT]     Group buildorder into waves buildable in "
+      "parallel\n"
+      "      --build-costs=FILE   Schedule buildorder waves with build times "
+      "from FILE\n"
       "  -F FMT, --format=FMT     Specify custom output for search and info\n"
+      "      --rate-limit=N       Send at most N requests per second\n"
+      "      --max-connections=N  Open at most N connections to the AUR\n"
+      "      --max-streams=N      Send at most N requests over each "
+      "connection at once\n"
+      "      --connect-timeout=DURATION\n"
+      "                           Give up on connecting after DURATION\n"
+      "      --keepalive=DURATION Probe idle connections every DURATION\n"
+      "      --cache-dir=DIR      Cache responses from the AUR in DIR\n"
+      "      --cache-ttl=DURATION Reuse cached responses younger than "
+      "DURATION\n"
+      "      --offline            Answer queries from the local metadata "
+      "index\n"
+      "      --metadata-file=FILE Location of the local metadata index\n"
+      "      --stats              Summarize request timings on exit\n"
       "\n"
       "Commands:\n"
       "  buildorder               Show build order\n"
@@ -58,7 +123,9 @@ struct Flags {
       "  resolve                  Resolve dependency strings\n"
       "  search                   Search for packages\n"
       "  show                     Dump package source file\n"
-      "  update                   Clone out of date foreign packages\n",
+      "  sync-metadata            Download the AUR's package metadata\n"
+      "  update                   Clone out of date foreign packages\n"
+      "  whatdepends              Find packages which depend on packages\n",
       stdout);
   exit(0);
 }
@@ -82,6 +149,22 @@ bool Flags::ParseFromArgv(int* argc, char*** argv) {
     ARG_PACMAN_CONFIG,
     ARG_SHOW_FILE,
     ARG_RESOLVE_DEPS,
+    ARG_CACHE_DIR,
+    ARG_CACHE_TTL,
+    ARG_OFFLINE,
+    ARG_METADATA_FILE,
+    ARG_JOBS,
+    ARG_DEPTH,
+    ARG_FILTER,
+    ARG_SNAPSHOT,
+    ARG_STATS,
+    ARG_WAVES,
+    ARG_BUILD_COSTS,
+    ARG_RATE_LIMIT,
+    ARG_MAX_CONNECTIONS,
+    ARG_MAX_STREAMS,
+    ARG_CONNECT_TIMEOUT,
+    ARG_KEEPALIVE,
   };
 
   static constexpr struct option opts[] = {
@@ -90,6 +173,12 @@ bool Flags::ParseFromArgv(int* argc, char*** argv) {
       { "quiet",           no_argument,       nullptr, 'q' },
       { "recurse",         no_argument,       nullptr, 'r' },
       { "chdir",           required_argument, nullptr, 'C' },
+      { "jobs",            required_argument, nullptr, ARG_JOBS },
+      { "depth",           required_argument, nullptr, ARG_DEPTH },
+      { "filter",          required_argument, nullptr, ARG_FILTER },
+      { "snapshot",        no_argument,       nullptr, ARG_SNAPSHOT },
+      { "waves",           optional_argument, nullptr, ARG_WAVES },
+      { "build-costs",     required_argument, nullptr, ARG_BUILD_COSTS },
       { "color",           required_argument, nullptr, ARG_COLOR },
       { "literal",         no_argument,       nullptr, ARG_LITERAL },
       { "resolve-deps",    required_argument, nullptr, ARG_RESOLVE_DEPS },
@@ -100,6 +189,16 @@ bool Flags::ParseFromArgv(int* argc, char*** argv) {
       { "version",         no_argument,       nullptr, ARG_VERSION },
       { "format",          required_argument, nullptr, 'F' },
       { "proxy",           required_argument, nullptr, ARG_PROXY },
+      { "rate-limit",      required_argument, nullptr, ARG_RATE_LIMIT },
+      { "max-connections", required_argument, nullptr, ARG_MAX_CONNECTIONS },
+      { "max-streams",     required_argument, nullptr, ARG_MAX_STREAMS },
+      { "connect-timeout", required_argument, nullptr, ARG_CONNECT_TIMEOUT },
+      { "keepalive",       required_argument, nullptr, ARG_KEEPALIVE },
+      { "cache-dir",       required_argument, nullptr, ARG_CACHE_DIR },
+      { "cache-ttl",       required_argument, nullptr, ARG_CACHE_TTL },
+      { "offline",         no_argument,       nullptr, ARG_OFFLINE },
+      { "metadata-file",   required_argument, nullptr, ARG_METADATA_FILE },
+      { "stats",           no_argument,       nullptr, ARG_STATS },
 
       // These are "private", and intentionally not documented in the manual or
       // usage.
@@ -168,6 +267,8 @@ bool Flags::ParseFromArgv(int* argc, char*** argv) {
       case ARG_SORT:
         command_options.sorter =
             sort::MakePackageSorter(sv_optarg, sort::OrderBy::ORDER_ASC);
+        command_options.view_sorter =
+            sort::MakePackageViewSorter(sv_optarg, sort::OrderBy::ORDER_ASC);
         if (command_options.sorter == nullptr) {
           std::println(stderr, "error: invalid arg to --sort: {}", sv_optarg);
           return false;
@@ -176,6 +277,8 @@ bool Flags::ParseFromArgv(int* argc, char*** argv) {
       case ARG_RSORT:
         command_options.sorter =
             sort::MakePackageSorter(sv_optarg, sort::OrderBy::ORDER_DESC);
+        command_options.view_sorter =
+            sort::MakePackageViewSorter(sv_optarg, sort::OrderBy::ORDER_DESC);
         if (command_options.sorter == nullptr) {
           std::println(stderr, "error: invalid arg to --rsort: {}", sv_optarg);
           return false;
@@ -195,6 +298,134 @@ bool Flags::ParseFromArgv(int* argc, char*** argv) {
       case ARG_PROXY:
         proxy = optarg;
         break;
+      case ARG_RATE_LIMIT: {
+        double rate;
+        if (!absl::SimpleAtod(sv_optarg, &rate) || !(rate > 0)) {
+          std::println(stderr, "error: invalid arg to --rate-limit: {}",
+                       sv_optarg);
+          return false;
+        }
+        rate_limit = rate;
+        break;
+      }
+      case ARG_MAX_CONNECTIONS: {
+        int connections;
+        if (!absl::SimpleAtoi(sv_optarg, &connections) || connections < 1) {
+          std::println(stderr, "error: invalid arg to --max-connections: {}",
+                       sv_optarg);
+          return false;
+        }
+        max_connections = connections;
+        break;
+      }
+      case ARG_MAX_STREAMS: {
+        int streams;
+        if (!absl::SimpleAtoi(sv_optarg, &streams) || streams < 1) {
+          std::println(stderr, "error: invalid arg to --max-streams: {}",
+                       sv_optarg);
+          return false;
+        }
+        max_streams = streams;
+        break;
+      }
+      case ARG_CONNECT_TIMEOUT: {
+        absl::Duration timeout;
+        if (!absl::ParseDuration(sv_optarg, &timeout) ||
+            timeout <= absl::ZeroDuration()) {
+          std::println(stderr, "error: invalid arg to --connect-timeout: {}",
+                       sv_optarg);
+          return false;
+        }
+        connect_timeout = timeout;
+        break;
+      }
+      case ARG_KEEPALIVE: {
+        absl::Duration interval;
+        if (!absl::ParseDuration(sv_optarg, &interval) ||
+            interval < absl::ZeroDuration()) {
+          std::println(stderr, "error: invalid arg to --keepalive: {}",
+                       sv_optarg);
+          return false;
+        }
+        keepalive = interval;
+        break;
+      }
+      case ARG_CACHE_DIR:
+        if (sv_optarg.empty()) {
+          std::println(stderr, "error: meaningless option: --cache-dir=''");
+          return false;
+        }
+        cache_directory = optarg;
+        break;
+      case ARG_CACHE_TTL: {
+        absl::Duration ttl;
+        if (!absl::ParseDuration(sv_optarg, &ttl) ||
+            ttl < absl::ZeroDuration()) {
+          std::println(stderr, "error: invalid arg to --cache-ttl: {}",
+                       sv_optarg);
+          return false;
+        }
+        cache_ttl = ttl;
+        break;
+      }
+      case ARG_JOBS: {
+        int jobs;
+        if (!absl::SimpleAtoi(sv_optarg, &jobs) || jobs < 1) {
+          std::println(stderr, "error: invalid arg to --jobs: {}", sv_optarg);
+          return false;
+        }
+        max_parallel_clones = jobs;
+        break;
+      }
+      case ARG_DEPTH:
+        if (!absl::SimpleAtoi(sv_optarg, &command_options.clone_depth) ||
+            command_options.clone_depth < 1) {
+          std::println(stderr, "error: invalid arg to --depth: {}", sv_optarg);
+          return false;
+        }
+        break;
+      case ARG_FILTER:
+        if (sv_optarg.empty()) {
+          std::println(stderr, "error: meaningless option: --filter=''");
+          return false;
+        }
+        command_options.clone_filter = optarg;
+        break;
+      case ARG_SNAPSHOT:
+        command_options.snapshot = true;
+        break;
+      case ARG_WAVES:
+        using BuildWaves = auracle::Auracle::CommandOptions::BuildWaves;
+
+        if (sv_optarg.empty() || sv_optarg == "text") {
+          command_options.build_waves = BuildWaves::TEXT;
+        } else if (sv_optarg == "json") {
+          command_options.build_waves = BuildWaves::JSON;
+        } else {
+          std::println(stderr, "error: invalid arg to --waves: {}", sv_optarg);
+          return false;
+        }
+        break;
+      case ARG_BUILD_COSTS:
+        if (sv_optarg.empty()) {
+          std::println(stderr, "error: meaningless option: --build-costs=''");
+          return false;
+        }
+        command_options.build_costs_file = optarg;
+        break;
+      case ARG_OFFLINE:
+        offline = true;
+        break;
+      case ARG_STATS:
+        stats = true;
+        break;
+      case ARG_METADATA_FILE:
+        if (sv_optarg.empty()) {
+          std::println(stderr, "error: meaningless option: --metadata-file=''");
+          return false;
+        }
+        metadata_file = optarg;
+        break;
       case ARG_PACMAN_CONFIG:
         pacman_config = optarg;
         break;
@@ -237,9 +468,26 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  aur::RequestStats stats;
+  const std::string stats_json_path = StatsJsonPath();
+  const bool collect_stats = flags.stats || !stats_json_path.empty();
+
   auracle::Auracle auracle(auracle::Auracle::Options()
                                .set_baseurl(flags.baseurl)
                                .set_proxy(flags.proxy)
+                               .set_cache_directory(flags.cache_directory)
+                               .set_cache_ttl(flags.cache_ttl)
+                               .set_max_parallel_clones(
+                                   flags.max_parallel_clones)
+                               .set_max_requests_per_second(flags.rate_limit)
+                               .set_max_connections(flags.max_connections)
+                               .set_max_streams_per_connection(
+                                   flags.max_streams)
+                               .set_connect_timeout(flags.connect_timeout)
+                               .set_keepalive(flags.keepalive)
+                               .set_metadata_file(flags.metadata_file)
+                               .set_offline(flags.offline)
+                               .set_stats(collect_stats ? &stats : nullptr)
                                .set_pacman(pacman.get()));
 
   const std::string_view action(argv[1]);
@@ -262,7 +510,9 @@ int main(int argc, char** argv) {
           {"search",      &auracle::Auracle::Search},
           {"show",        &auracle::Auracle::Show},
           {"sync",        &auracle::Auracle::Outdated},
+          {"sync-metadata", &auracle::Auracle::SyncMetadata},
           {"update",      &auracle::Auracle::Update},
+          {"whatdepends", &auracle::Auracle::WhatDepends},
           // clang-format on
       };
 
@@ -272,7 +522,22 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  return (auracle.*iter->second)(args, flags.command_options) < 0 ? 1 : 0;
+  const int r = (auracle.*iter->second)(args, flags.command_options);
+
+  if (flags.stats) {
+    std::print(stderr, "{}", stats.Summary());
+  }
+
+  if (!stats_json_path.empty()) {
+    std::ofstream out(stats_json_path, std::ofstream::trunc);
+    out << stats.ToJson() << '\n';
+    if (!out) {
+      std::println(stderr, "error: failed to write stats to {}",
+                   stats_json_path);
+    }
+  }
+
+  return r < 0 ? 1 : 0;
 }
 
 /* vim: set et ts=2 sw=2: */
@@ -0,0 +1,16 @@
+#include <unistd.h>
+
+#include "benchmark/benchmark.h"
+
+int main(int argc, char** argv) {
+  setenv("TZ", "UTC", 1);
+  setenv("LC_TIME", "C", 1);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -113,12 +113,13 @@ class TestCase(unittest.TestCase):
             """)
             )
 
-    def Auracle(self, args):
+    def Auracle(self, args, env=None):
         requests_file = tempfile.NamedTemporaryFile(
             dir=self.tempdir, prefix='requests-', delete=False
         ).name
 
         env = {
+            **(env or {}),
             'PATH': f'{__scriptdir__}/fakeaur:{os.getenv("PATH")}',
             'AURACLE_TEST_TMPDIR': self.tempdir,
             'AURACLE_DEBUG': f'requests:{requests_file}',
@@ -1,7 +1,9 @@
 #!/usr/bin/env python
 # SPDX-License-Identifier: MIT
 
+import glob
 import gzip
+import hashlib
 import http.server
 import io
 import json
@@ -22,6 +24,7 @@ class FakeAurHandler(http.server.BaseHTTPRequestHandler):
             '/rpc': self.handle_rpc,
             '/cgit/aur.git/snapshot': self.handle_download,
             '/cgit/aur.git/plain/': self.handle_source_file,
+            '/packages-meta-ext-v1.json.gz': self.handle_metadata,
         }
 
         url = urllib.parse.urlparse(self.path)
@@ -84,8 +87,11 @@ class FakeAurHandler(http.server.BaseHTTPRequestHandler):
         if len(args) == 1:
             try:
                 status_code = int(next(iter(args)))
+                # Don't keep throttled clients waiting.
+                headers = [('Retry-After', '0')] if status_code == 429 else []
                 return self.respond(
                     status_code=status_code,
+                    headers=headers,
                     response=f'{status_code}: fridge too loud\n'.encode(),
                 )
             except ValueError:
@@ -145,6 +151,17 @@ class FakeAurHandler(http.server.BaseHTTPRequestHandler):
 
             return self.respond(headers=headers, response=response)
 
+    def handle_metadata(self, command, url):
+        packages = {}
+        for path in sorted(glob.glob(os.path.join(DBROOT, 'info', '*'))):
+            with open(path) as f:
+                for result in json.load(f)['results']:
+                    packages[result['Name']] = result
+
+        response = gzip.compress(json.dumps(list(packages.values())).encode())
+
+        return self.respond(response=response)
+
     def handle_source_file(self, command, url):
         queryparams = urllib.parse.parse_qs(url.query)
         pkgname = self.last_of(queryparams.get('h'))
@@ -156,6 +173,12 @@ class FakeAurHandler(http.server.BaseHTTPRequestHandler):
             return self.respond(status_code=404)
 
     def respond(self, status_code=200, headers=[], response=None):
+        if status_code == 200 and response:
+            etag = f'"{hashlib.sha1(response).hexdigest()}"'
+            if self.headers.get('If-None-Match') == etag:
+                status_code, response = 304, None
+            headers = list(headers) + [('ETag', etag)]
+
         self.send_response(status_code)
 
         for k, v in headers:
@@ -3,6 +3,8 @@
 
 import auracle_test
 
+import json
+import os
 import textwrap
 
 
@@ -126,10 +128,66 @@ class TestBuildOrder(auracle_test.TestCase):
         r = self.Auracle(['buildorder', 'python-fontpens'])
         self.assertEqual(0, r.process.returncode)
         self.assertIn(
-            'warning: found dependency cycle: [ python-fontpens -> python-fontparts -> python-fontpens ]',
+            'warning: found dependency cycle: python-fontpens python-fontparts '
+            'python-booleanoperations',
             r.process.stderr.decode().strip().splitlines(),
         )
 
+    def testDependencyCycleIsBuiltTogether(self):
+        r = self.Auracle(['buildorder', 'python-fontpens'])
+        self.assertEqual(0, r.process.returncode)
+
+        lines = r.process.stdout.decode().strip().splitlines()
+        self.assertEqual(
+            [
+                'CYCLE python-booleanoperations python-fontparts '
+                'python-fontpens',
+                'AUR python-booleanoperations python-booleanoperations',
+                'AUR python-fontparts python-fontparts',
+                'TARGETAUR python-fontpens python-fontpens',
+            ],
+            lines[-4:],
+        )
+
+    def testDependencyCycleIsBuiltTogetherInWaves(self):
+        r = self.Auracle(['buildorder', '--waves', 'python-fontpens'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertMultiLineEqual(
+            textwrap.dedent("""\
+                0 python-fontmath python-fontmath
+                0 python-pyclipper python-pyclipper
+                0 python-defcon python-defcon
+                CYCLE python-booleanoperations python-fontparts python-fontpens
+                1 python-booleanoperations python-booleanoperations
+                1 python-fontparts python-fontparts
+                1 python-fontpens python-fontpens
+            """),
+            r.process.stdout.decode(),
+        )
+
+        r = self.Auracle(['buildorder', '--waves=json', 'python-fontpens'])
+        self.assertEqual(0, r.process.returncode)
+
+        nodes = json.loads(r.process.stdout)['nodes']
+        self.assertListEqual(
+            [
+                ('python-fontmath', 0, None),
+                ('python-pyclipper', 0, None),
+                ('python-defcon', 0, None),
+                ('python-booleanoperations', 1, 0),
+                ('python-fontparts', 1, 0),
+                ('python-fontpens', 1, 0),
+            ],
+            [(n['pkgbase'], n['wave'], n.get('cycle')) for n in nodes],
+        )
+
+    def testRequestsOneLevelAtATime(self):
+        r = self.Auracle(['buildorder', 'ocaml-configurator'])
+        self.assertEqual(0, r.process.returncode)
+
+        # The target, its dependencies, and theirs.
+        self.assertListEqual(['/rpc/v5/info'] * 3, r.request_uris)
+
     def testNoDependencies(self):
         r = self.Auracle(['buildorder', 'mingw-w64-environment'])
         self.assertEqual(0, r.process.returncode)
@@ -138,6 +196,139 @@ class TestBuildOrder(auracle_test.TestCase):
             r.process.stdout.decode().strip().splitlines(),
         )
 
+    def testWaves(self):
+        r = self.Auracle(
+            ['buildorder', '--waves', 'ocaml-configurator', 'ocaml-cryptokit'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertMultiLineEqual(
+            textwrap.dedent("""\
+                0 ocaml-sexplib0 ocaml-sexplib0
+                0 ocaml-zarith ocaml-zarith
+                1 ocaml-base ocaml-base
+                1 ocaml-cryptokit ocaml-cryptokit
+                2 ocaml-stdio ocaml-stdio
+                3 ocaml-configurator ocaml-configurator
+            """),
+            r.process.stdout.decode(),
+        )
+
+    def testWavesAsJson(self):
+        r = self.Auracle(['buildorder', '--waves=json', 'ocaml-configurator'])
+        self.assertEqual(0, r.process.returncode)
+
+        nodes = json.loads(r.process.stdout)['nodes']
+        self.assertListEqual(
+            [
+                {
+                    'pkgbase': 'ocaml-sexplib0',
+                    'pkgnames': ['ocaml-sexplib0'],
+                    'wave': 0,
+                    'depends': [],
+                },
+                {
+                    'pkgbase': 'ocaml-base',
+                    'pkgnames': ['ocaml-base'],
+                    'wave': 1,
+                    'depends': ['ocaml-sexplib0'],
+                },
+                {
+                    'pkgbase': 'ocaml-stdio',
+                    'pkgnames': ['ocaml-stdio'],
+                    'wave': 2,
+                    'depends': ['ocaml-base'],
+                },
+                {
+                    'pkgbase': 'ocaml-configurator',
+                    'pkgnames': ['ocaml-configurator'],
+                    'wave': 3,
+                    'depends': ['ocaml-base', 'ocaml-stdio'],
+                },
+            ],
+            nodes,
+        )
+
+    def testWavesReportUnknownDependencies(self):
+        r = self.Auracle(['buildorder', '--waves', 'auracle-git'])
+        self.assertEqual(1, r.process.returncode)
+        self.assertIn(
+            'error: unknown dependency: auracle-git -> nlohmann-json -> cmake',
+            r.process.stderr.decode().splitlines(),
+        )
+        self.assertMultiLineEqual(
+            textwrap.dedent("""\
+                0 nlohmann-json nlohmann-json
+                1 auracle-git auracle-git
+            """),
+            r.process.stdout.decode(),
+        )
+
+    def WriteBuildCosts(self, contents):
+        path = os.path.join(self.tempdir, 'build-costs')
+        with open(path, 'w') as f:
+            f.write(textwrap.dedent(contents))
+        return path
+
+    def testBuildCosts(self):
+        # ocaml-cryptokit is left out, so it's assumed to take the average.
+        costs = self.WriteBuildCosts("""\
+            # pkgbase seconds
+            ocaml-sexplib0 10
+            ocaml-base 20
+            ocaml-stdio 5
+            ocaml-configurator 5
+            ocaml-zarith 60
+        """)
+
+        r = self.Auracle([
+            'buildorder', '--build-costs={}'.format(costs),
+            'ocaml-configurator', 'ocaml-cryptokit'
+        ])
+        self.assertEqual(0, r.process.returncode)
+        self.assertMultiLineEqual(
+            textwrap.dedent("""\
+                0 ocaml-sexplib0 0 40 ocaml-sexplib0
+                0 ocaml-zarith 0 0 ocaml-zarith
+                1 ocaml-base 10 40 ocaml-base
+                1 ocaml-cryptokit 60 0 ocaml-cryptokit
+                2 ocaml-stdio 30 40 ocaml-stdio
+                3 ocaml-configurator 35 40 ocaml-configurator
+                CRITICAL 80 ocaml-zarith ocaml-cryptokit
+            """),
+            r.process.stdout.decode(),
+        )
+
+        r = self.Auracle([
+            'buildorder', '--waves=json', '--build-costs={}'.format(costs),
+            'ocaml-configurator', 'ocaml-cryptokit'
+        ])
+        self.assertEqual(0, r.process.returncode)
+
+        graph = json.loads(r.process.stdout)
+        self.assertEqual(80, graph['makespan'])
+        self.assertListEqual(['ocaml-zarith', 'ocaml-cryptokit'],
+                             graph['critical_path'])
+        self.assertDictEqual(
+            {
+                'pkgbase': 'ocaml-cryptokit',
+                'pkgnames': ['ocaml-cryptokit'],
+                'wave': 1,
+                'depends': ['ocaml-zarith'],
+                'cost': 20,
+                'earliest_start': 60,
+                'slack': 0,
+            },
+            graph['nodes'][5],
+        )
+
+    def testBadBuildCosts(self):
+        costs = self.WriteBuildCosts('ocaml-base forever\n')
+
+        r = self.Auracle(
+            ['buildorder', '--build-costs={}'.format(costs), 'ocaml-base'])
+        self.assertNotEqual(0, r.process.returncode)
+        self.assertIn('error: failed to read build costs', r.process.stderr.decode())
+        self.assertListEqual([], r.request_uris)
+
 
 if __name__ == '__main__':
     auracle_test.main()
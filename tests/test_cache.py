@@ -0,0 +1,51 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: MIT
+
+import auracle_test
+
+
+class TestCache(auracle_test.TestCase):
+    def AuracleWithCache(self, args):
+        return self.Auracle([f'--cache-dir={self.tempdir}/cache'] + args)
+
+    def testServesFreshResponsesFromCache(self):
+        r1 = self.AuracleWithCache(['info', 'auracle-git'])
+        self.assertEqual(0, r1.process.returncode)
+        self.assertCountEqual(r1.request_uris, ['/rpc/v5/info'])
+
+        r2 = self.AuracleWithCache(['info', 'auracle-git'])
+        self.assertEqual(0, r2.process.returncode)
+        self.assertListEqual(r2.request_uris, [])
+        self.assertEqual(r1.process.stdout, r2.process.stdout)
+
+    def testRevalidatesStaleResponses(self):
+        r1 = self.AuracleWithCache(['--cache-ttl=0s', 'info', 'auracle-git'])
+        self.assertEqual(0, r1.process.returncode)
+        self.assertNotIn('if-none-match', r1.requests_sent[0].headers)
+
+        r2 = self.AuracleWithCache(['--cache-ttl=0s', 'info', 'auracle-git'])
+        self.assertEqual(0, r2.process.returncode)
+        self.assertCountEqual(r2.request_uris, ['/rpc/v5/info'])
+        self.assertIn('if-none-match', r2.requests_sent[0].headers)
+        self.assertEqual(r1.process.stdout, r2.process.stdout)
+
+    def testCacheIsKeyedByRequest(self):
+        r = self.AuracleWithCache(['info', 'auracle-git'])
+        self.assertEqual(0, r.process.returncode)
+
+        r = self.AuracleWithCache(['info', 'pkgfile-git'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertCountEqual(r.request_uris, ['/rpc/v5/info'])
+        self.assertIn('pkgfile-git', r.process.stdout.decode())
+
+    def testErrorsAreNotCached(self):
+        r = self.AuracleWithCache(['info', '503'])
+        self.assertNotEqual(0, r.process.returncode)
+
+        r = self.AuracleWithCache(['info', '503'])
+        self.assertNotEqual(0, r.process.returncode)
+        self.assertCountEqual(r.request_uris, ['/rpc/v5/info'])
+
+
+if __name__ == '__main__':
+    auracle_test.main()
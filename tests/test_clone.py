@@ -26,6 +26,87 @@ class TestClone(auracle_test.TestCase):
 
         self.assertCountEqual(r.request_uris, ['/rpc/v5/info'])
 
+    def testCloneHonorsJobLimit(self):
+        packages = ['auracle-git', 'pkgfile-git', 'nlohmann-json', 'ocaml-base']
+
+        r = self.Auracle(['clone', '--jobs=1'] + packages)
+        self.assertEqual(r.process.returncode, 0)
+        for pkgname in packages:
+            self.assertPkgbuildExists(pkgname)
+
+        self.assertFalse(
+            os.path.exists(os.path.join(self.tempdir, 'git-overlapped'))
+        )
+
+    def GitArgs(self, pkgname, action):
+        with open(os.path.join(self.tempdir, pkgname, action)) as f:
+            return f.read().splitlines()
+
+    def testShallowClone(self):
+        r = self.Auracle(['clone', '--depth=1', 'auracle-git'])
+        self.assertEqual(r.process.returncode, 0)
+        self.assertIn('--depth=1', self.GitArgs('auracle-git', 'clone'))
+
+        # A shallow clone is updated by fetching to the same depth and moving
+        # onto what was fetched, as a pull can't relate the two histories.
+        r = self.Auracle(['clone', '--depth=1', 'auracle-git'])
+        self.assertEqual(r.process.returncode, 0)
+        self.assertIn('--depth=1', self.GitArgs('auracle-git', 'fetch'))
+        self.assertIn('FETCH_HEAD', self.GitArgs('auracle-git', 'reset'))
+        self.assertFalse(
+            os.path.exists(os.path.join(self.tempdir, 'auracle-git', 'pull')))
+
+    def testPartialClone(self):
+        r = self.Auracle(['clone', '--filter=blob:none', 'auracle-git'])
+        self.assertEqual(r.process.returncode, 0)
+        self.assertIn('--filter=blob:none', self.GitArgs('auracle-git', 'clone'))
+
+    def testFullCloneByDefault(self):
+        r = self.Auracle(['clone', 'auracle-git'])
+        self.assertEqual(r.process.returncode, 0)
+
+        args = self.GitArgs('auracle-git', 'clone')
+        self.assertFalse(any(a.startswith('--depth') for a in args))
+        self.assertFalse(any(a.startswith('--filter') for a in args))
+
+    def testInvalidDepth(self):
+        r = self.Auracle(['clone', '--depth=0', 'auracle-git'])
+        self.assertNotEqual(r.process.returncode, 0)
+        self.assertIn('invalid arg to --depth', r.process.stderr.decode())
+
+    def testCloneSnapshot(self):
+        r = self.Auracle(['clone', '--snapshot', 'auracle-git', 'pkgfile-git'])
+        self.assertEqual(r.process.returncode, 0)
+
+        for pkgname in ('auracle-git', 'pkgfile-git'):
+            self.assertIn(
+                f'snapshot complete: {os.path.join(self.tempdir, pkgname)}',
+                r.process.stdout.decode().splitlines(),
+            )
+            self.assertTrue(
+                os.path.exists(os.path.join(self.tempdir, pkgname, 'PKGBUILD'))
+            )
+            self.assertFalse(
+                os.path.exists(os.path.join(self.tempdir, pkgname, '.git'))
+            )
+
+        self.assertCountEqual(
+            r.request_uris,
+            [
+                '/rpc/v5/info',
+                '/cgit/aur.git/snapshot/auracle-git.tar.gz',
+                '/cgit/aur.git/snapshot/pkgfile-git.tar.gz',
+            ],
+        )
+
+    def testCloneSnapshotFailureReportsError(self):
+        r = self.Auracle(['clone', '--snapshot', 'yaourt'])
+        self.assertNotEqual(r.process.returncode, 0)
+        self.assertIn(
+            'error: clone failed for yaourt: INVALID_ARGUMENT: decompression error',
+            r.process.stderr.decode(),
+        )
+
     def testCloneRecursive(self):
         r = self.Auracle(['clone', '-r', 'auracle-git'])
         self.assertEqual(r.process.returncode, 0)
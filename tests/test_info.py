@@ -33,6 +33,23 @@ class TestInfo(auracle_test.TestCase):
             r.process.stderr.decode(),
         )
 
+    def testRetriesThrottledRequests(self):
+        r = self.Auracle(['info', '429'])
+        self.assertNotEqual(0, r.process.returncode)
+
+        # The first attempt, and three retries.
+        self.assertListEqual(['/rpc/v5/info'] * 4, r.request_uris)
+
+    def testRateLimit(self):
+        r = self.Auracle(['--rate-limit=100', 'info', 'auracle-git'])
+        self.assertEqual(0, r.process.returncode)
+
+        r = self.Auracle(['--rate-limit=0', 'info', 'auracle-git'])
+        self.assertNotEqual(0, r.process.returncode)
+        self.assertIn(
+            'error: invalid arg to --rate-limit: 0', r.process.stderr.decode()
+        )
+
 
 if __name__ == '__main__':
     auracle_test.main()
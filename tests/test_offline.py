@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: MIT
+
+import auracle_test
+
+import gzip
+import json
+import os.path
+
+
+class TestOffline(auracle_test.TestCase):
+    def setUp(self):
+        super().setUp()
+        self.metadata_file = os.path.join(self.tempdir, 'metadata', 'aur-metadata')
+
+    def AuracleWithMetadata(self, args):
+        return self.Auracle([f'--metadata-file={self.metadata_file}'] + args)
+
+    def SyncMetadata(self):
+        r = self.AuracleWithMetadata(['sync-metadata'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(r.request_uris, ['/packages-meta-ext-v1.json.gz'])
+
+    def testSyncMetadata(self):
+        r = self.AuracleWithMetadata(['sync-metadata'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertTrue(os.path.exists(self.metadata_file))
+        self.assertIn('synced metadata for 35 packages', r.process.stdout.decode())
+
+    def testSyncMetadataFromFile(self):
+        dump = os.path.join(self.tempdir, 'packages-meta-ext-v1.json')
+        with open(dump, 'w') as f:
+            json.dump([{'Name': 'auracle-git', 'PackageBase': 'auracle-git'}], f)
+
+        r = self.AuracleWithMetadata(['sync-metadata', dump])
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(r.request_uris, [])
+
+        r = self.AuracleWithMetadata(['--offline', 'search', '--quiet', 'aura'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertEqual('auracle-git\n', r.process.stdout.decode())
+
+    def testSyncMetadataRejectsInvalidDump(self):
+        dump = os.path.join(self.tempdir, 'packages-meta-ext-v1.json.gz')
+        with open(dump, 'wb') as f:
+            f.write(gzip.compress(b'this is not json'))
+
+        r = self.AuracleWithMetadata(['sync-metadata', dump])
+        self.assertNotEqual(0, r.process.returncode)
+        self.assertFalse(os.path.exists(self.metadata_file))
+
+    def testOfflineInfo(self):
+        self.SyncMetadata()
+
+        r = self.AuracleWithMetadata(['--offline', 'info', 'auracle-git', 'pkgfile-git'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(r.request_uris, [])
+
+        online = self.Auracle(['info', 'auracle-git', 'pkgfile-git'])
+        self.assertEqual(online.process.stdout, r.process.stdout)
+
+    def testOfflineSearch(self):
+        self.SyncMetadata()
+
+        r = self.AuracleWithMetadata(['--offline', 'search', '--quiet', 'ocaml'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(r.request_uris, [])
+        self.assertIn('ocaml-configurator', r.process.stdout.decode().splitlines())
+
+        r = self.AuracleWithMetadata(['--offline', '--literal', 'search', 'a'])
+        self.assertNotEqual(0, r.process.returncode)
+        self.assertIn('Query arg too small', r.process.stderr.decode())
+
+    def testOfflineBuildOrder(self):
+        self.SyncMetadata()
+
+        r = self.AuracleWithMetadata(['--offline', 'buildorder', 'ocaml-configurator'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(r.request_uris, [])
+
+        online = self.Auracle(['buildorder', 'ocaml-configurator'])
+        self.assertEqual(online.process.stdout, r.process.stdout)
+
+    def testOfflineCloneFails(self):
+        self.SyncMetadata()
+
+        r = self.AuracleWithMetadata(['--offline', 'clone', 'auracle-git'])
+        self.assertNotEqual(0, r.process.returncode)
+        self.assertListEqual(r.request_uris, [])
+
+    def testOfflineWithoutIndexFails(self):
+        r = self.AuracleWithMetadata(['--offline', 'info', 'auracle-git'])
+        self.assertNotEqual(0, r.process.returncode)
+        self.assertIn('sync-metadata', r.process.stderr.decode())
+        self.assertListEqual(r.request_uris, [])
+
+
+if __name__ == '__main__':
+    auracle_test.main()
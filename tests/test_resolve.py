@@ -45,6 +45,19 @@ class TestResolve(auracle_test.TestCase):
             r.process.stdout.decode().splitlines(),
         )
 
+    def testOverlappingDependenciesShareRequests(self):
+        r = self.Auracle(['resolve', '-q', 'curl', 'curl>8', 'curl=8.7.1.r201.gc8e0cd1de8'])
+        self.assertEqual(0, r.process.returncode)
+
+        # Every dependency searches for the same name, which is only sent once.
+        self.assertCountEqual(
+            ['/rpc/v5/search/curl?by=provides', '/rpc/v5/info'], r.request_uris
+        )
+        self.assertCountEqual(
+            ['curl-c-ares', 'curl-git', 'curl-http3-ngtcp2', 'curl-quiche-git'],
+            r.process.stdout.decode().splitlines(),
+        )
+
     def testNoProvidersFound(self):
         r = self.Auracle(['resolve', 'curl=42'])
         self.assertEqual(0, r.process.returncode)
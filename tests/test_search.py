@@ -55,14 +55,12 @@ class TestSearch(auracle_test.TestCase):
         packagecount = len(r1.process.stdout.decode().splitlines())
         self.assertGreater(packagecount, 0)
 
-        # search again with the term duplicated. two requests are made, but the
-        # resultcount is the same as the results are deduped.
+        # search again with the term duplicated. the identical requests are
+        # coalesced into one, and the resultcount is the same as the results
+        # are deduped.
         r2 = self.Auracle(['search', '--quiet', 'aura', 'aura'])
-        self.assertCountEqual(
-            [
-                '/rpc/v5/search/aura?by=name-desc',
-                '/rpc/v5/search/aura?by=name-desc',
-            ],
+        self.assertListEqual(
+            ['/rpc/v5/search/aura?by=name-desc'],
             r2.request_uris,
         )
         self.assertEqual(packagecount, len(r2.process.stdout.decode().splitlines()))
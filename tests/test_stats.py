@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: MIT
+
+import auracle_test
+
+import json
+import os.path
+
+
+class TestStats(auracle_test.TestCase):
+    def testStatsSummary(self):
+        r = self.Auracle(['--stats', 'info', 'auracle-git'])
+        self.assertEqual(0, r.process.returncode)
+
+        stderr = r.process.stderr.decode()
+        self.assertIn('requests: 1 (0 cached', stderr)
+        for phase in ('dns', 'connect', 'ttfb', 'transfer', 'parse', 'callback'):
+            self.assertRegex(stderr, rf'(?m)^{phase} ')
+
+    def testStatsReportConcurrency(self):
+        r = self.Auracle(['--stats', '--max-connections=1', 'info', 'auracle-git'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertIn(
+            'concurrency: 1 connections opened, 1 requests in flight at peak',
+            r.process.stderr.decode(),
+        )
+
+    def testInvalidConnectionOptions(self):
+        for flag in (
+            '--max-connections=0',
+            '--max-streams=-1',
+            '--connect-timeout=0s',
+            '--keepalive=forever',
+        ):
+            r = self.Auracle([flag, 'info', 'auracle-git'])
+            self.assertNotEqual(0, r.process.returncode)
+            self.assertIn(
+                'error: invalid arg to {}'.format(flag.split('=')[0]),
+                r.process.stderr.decode(),
+            )
+
+    def testNoStatsByDefault(self):
+        r = self.Auracle(['info', 'auracle-git'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertNotIn('requests:', r.process.stderr.decode())
+
+    def testStatsJson(self):
+        stats_file = os.path.join(self.tempdir, 'stats.json')
+
+        r = self.Auracle(
+            ['clone', '--snapshot', 'auracle-git', 'pkgfile-git'],
+            env={'AURACLE_STATS': f'json:{stats_file}'},
+        )
+        self.assertEqual(0, r.process.returncode)
+
+        with open(stats_file) as f:
+            stats = json.load(f)
+
+        self.assertEqual(3, stats['requests'])
+        self.assertGreater(stats['bytes_in'], 0)
+        self.assertIn('p95_us', stats['phases']['ttfb'])
+        self.assertCountEqual(
+            [os.path.basename(t['url']) for t in stats['request_timings']],
+            ['info', 'auracle-git.tar.gz', 'pkgfile-git.tar.gz'],
+        )
+
+
+if __name__ == '__main__':
+    auracle_test.main()
@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: MIT
+
+import auracle_test
+
+import os.path
+
+
+class TestWhatDepends(auracle_test.TestCase):
+    def testSearchesEachDependencyKind(self):
+        r = self.Auracle(['whatdepends', '--quiet', 'ocaml-sexplib0'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertEqual('ocaml-base\n', r.process.stdout.decode())
+        self.assertCountEqual(
+            r.request_uris,
+            [
+                '/rpc/v5/search/ocaml-sexplib0?by=depends',
+                '/rpc/v5/search/ocaml-sexplib0?by=makedepends',
+                '/rpc/v5/search/ocaml-sexplib0?by=checkdepends',
+            ],
+        )
+
+    def testHonorsResolveDeps(self):
+        r = self.Auracle(
+            ['whatdepends', '--quiet', '--resolve-deps=depends', 'ocaml-sexplib0']
+        )
+        self.assertEqual(0, r.process.returncode)
+        self.assertCountEqual(
+            r.request_uris, ['/rpc/v5/search/ocaml-sexplib0?by=depends']
+        )
+
+
+class TestWhatDependsOffline(auracle_test.TestCase):
+    def setUp(self):
+        super().setUp()
+        self.metadata_file = os.path.join(self.tempdir, 'aur-metadata')
+
+        r = self.Auracle([f'--metadata-file={self.metadata_file}', 'sync-metadata'])
+        self.assertEqual(0, r.process.returncode)
+
+    def AuracleOffline(self, args):
+        return self.Auracle([f'--metadata-file={self.metadata_file}', '--offline'] + args)
+
+    def testDirectDependents(self):
+        r = self.AuracleOffline(['whatdepends', '--quiet', 'ocaml-base'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(r.request_uris, [])
+        self.assertListEqual(
+            ['ocaml-configurator', 'ocaml-pcre', 'ocaml-stdio'],
+            r.process.stdout.decode().splitlines(),
+        )
+
+    def testMatchesVersionedDependencies(self):
+        r = self.AuracleOffline(['whatdepends', '--quiet', 'curl'])
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(
+            [
+                'ocaml-curl',
+                'pacman-fancy-progress-git',
+                'pacman-git',
+                'pacman-pb',
+                'pkgfile-git',
+            ],
+            r.process.stdout.decode().splitlines(),
+        )
+
+    def testRecursiveDependents(self):
+        r = self.AuracleOffline(
+            ['whatdepends', '--quiet', '--recurse', 'ocaml-sexplib0']
+        )
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(
+            [
+                'gapi-ocaml',
+                'google-drive-ocamlfuse',
+                'ocaml-base',
+                'ocaml-configurator',
+                'ocaml-pcre',
+                'ocaml-stdio',
+                'ocamlnet',
+            ],
+            r.process.stdout.decode().splitlines(),
+        )
+
+        r = self.AuracleOffline(
+            [
+                'whatdepends',
+                '--quiet',
+                '--recurse',
+                '--resolve-deps=depends',
+                'ocaml-sexplib0',
+            ]
+        )
+        self.assertEqual(0, r.process.returncode)
+        self.assertListEqual(
+            ['ocaml-base', 'ocaml-configurator', 'ocaml-stdio'],
+            r.process.stdout.decode().splitlines(),
+        )
+
+
+if __name__ == '__main__':
+    auracle_test.main()